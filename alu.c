@@ -0,0 +1,81 @@
+#include "alu.h"
+
+uint16_t alu_add[2][0x100][0x100];
+uint16_t alu_sub[2][0x100][0x100];
+uint16_t alu_daa[ALU_DAA_SIZE];
+uint8_t alu_inc[0x100];
+uint8_t alu_dec[0x100];
+uint8_t alu_zero[0x100];
+
+static inline uint16_t alu_AF(uint8_t a, uint8_t f){
+	return a << 8 | f;
+}
+
+// a + b + carry, H from bit 3, C from bit 7
+static uint16_t alu_Add(uint8_t a, uint8_t b, uint8_t carry){
+	uint16_t res = a + b + carry;
+	uint8_t f = alu_zero[res & 0xFF];
+
+	if ((a & 0x0F) + (b & 0x0F) + carry > 0x0F)
+		f |= ALU_FLAG_H;
+	if (res > 0xFF)
+		f |= ALU_FLAG_C;
+	return alu_AF(res, f);
+}
+
+// a - b - carry, H and C are borrows from bit 4 and bit 8
+static uint16_t alu_Sub(uint8_t a, uint8_t b, uint8_t carry){
+	uint8_t res = a - b - carry;
+	uint8_t f = alu_zero[res] | ALU_FLAG_N;
+
+	if ((a & 0x0F) < (b & 0x0F) + carry)
+		f |= ALU_FLAG_H;
+	if (a < b + carry)
+		f |= ALU_FLAG_C;
+	return alu_AF(res, f);
+}
+
+// Adjust A to BCD after an addition (N clear) or subtraction (N set)
+static uint16_t alu_Daa(uint8_t a, uint8_t f){
+	uint8_t res = a;
+	uint8_t c = f & ALU_FLAG_C;
+
+	if (f & ALU_FLAG_N){
+		if (f & ALU_FLAG_C)
+			res -= 0x60;
+		if (f & ALU_FLAG_H)
+			res -= 0x06;
+	}else{
+		if ((f & ALU_FLAG_C) || a > 0x99){
+			res += 0x60;
+			c = ALU_FLAG_C;
+		}
+		if ((f & ALU_FLAG_H) || (a & 0x0F) > 0x09)
+			res += 0x06;
+	}
+	// H is always cleared, N is kept
+	return alu_AF(res, alu_zero[res] | (f & ALU_FLAG_N) | c);
+}
+
+void alu_Init(void){
+	uint16_t a, b, i;
+	uint8_t carry;
+
+	for (a = 0; a < 0x100; a++)
+		alu_zero[a] = a ? 0 : ALU_FLAG_Z;
+	for (a = 0; a < 0x100; a++){
+		alu_inc[a] = alu_Add(a, 1, 0) & (ALU_FLAG_Z | ALU_FLAG_H);
+		alu_dec[a] = alu_Sub(a, 1, 0) & (ALU_FLAG_Z | ALU_FLAG_N | ALU_FLAG_H);
+	}
+	for (carry = 0; carry < 2; carry++){
+		for (a = 0; a < 0x100; a++){
+			for (b = 0; b < 0x100; b++){
+				alu_add[carry][a][b] = alu_Add(a, b, carry);
+				alu_sub[carry][a][b] = alu_Sub(a, b, carry);
+			}
+		}
+	}
+	for (i = 0; i < ALU_DAA_SIZE; i++)
+		alu_daa[i] = alu_Daa(i & 0xFF, (i >> 4) & (ALU_FLAG_N | ALU_FLAG_H | ALU_FLAG_C));
+	return;
+}
@@ -0,0 +1,41 @@
+#ifndef _ALU_H
+#define _ALU_H
+
+#include <stdint.h>
+
+/*
+
+	ALU lookup tables
+
+	Result and flags of the 8 bit arithmetic instructions and DAA are
+	precomputed by alu_Init, an instruction is a table load instead of
+	half-carry and carry compares. Entries of the 16 bit tables are the AF
+	register after the operation: A in the high byte, F in the low byte.
+
+	The tables are checked against a bit level reference model by
+	tools/alu_check.c, run it after changing alu.c.
+
+*/
+
+// Flags in F register
+#define ALU_FLAG_Z (0x80)
+#define ALU_FLAG_N (0x40)
+#define ALU_FLAG_H (0x20)
+#define ALU_FLAG_C (0x10)
+
+#define ALU_DAA_SIZE (0x800)
+
+extern uint16_t alu_add[2][0x100][0x100]; // [carry][A][n] -> AF, ADD and ADC
+extern uint16_t alu_sub[2][0x100][0x100]; // [carry][A][n] -> AF, SUB, SBC and CP
+extern uint16_t alu_daa[ALU_DAA_SIZE]; // [N H C A] -> AF, see ALU_DAA_INDEX
+extern uint8_t alu_inc[0x100]; // [r] -> Z N H of INC r, C is not affected
+extern uint8_t alu_dec[0x100]; // [r] -> Z N H of DEC r, C is not affected
+extern uint8_t alu_zero[0x100]; // [r] -> Z flag of r, AND OR XOR
+
+// alu_daa index from the AF register
+#define ALU_DAA_INDEX(af) (((af) >> 8) | ((af) & (ALU_FLAG_N | ALU_FLAG_H | ALU_FLAG_C)) << 4)
+
+// Fill the tables, done once before running any Cpu
+void alu_Init(void);
+
+#endif
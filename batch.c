@@ -0,0 +1,346 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "vm.h"
+#include "pool.h"
+
+/*
+	Batch runner, runs a job list on a work stealing thread pool
+
+	Every job runs in its own headless VM. A job list line is
+
+		<rom> <input script|-> <frames> [ram dump|-]
+
+	'#' starts a comment. The ROM is booted through the bios, "-" runs the
+	bios alone on the Nintendo logo. An input script holds "<frame>
+	<buttons>" lines, buttons is a hex JOYPAD_* mask pressed from that
+	frame on.
+
+	The report has one line per job in list order: frames and clock cycles
+	run, idle loops detected, skips and clock cycles skipped, hash of VRAM
+	and OAM, serial output, status and host time. The
+	order and content of the report do not depend on the thread count.
+*/
+
+#define BATCH_LINE_SIZE (1024)
+#define BATCH_SERIAL_SIZE (0x10000) // serial output kept per job
+
+// Input script entry
+typedef struct{
+	uint32_t frame;
+	uint8_t buttons;
+}Batch_Input;
+
+// Job and its results
+typedef struct{
+	char *rom;
+	char *input;
+	char *dump;
+	uint32_t frames;
+	uint64_t cycles;
+	uint64_t idle_loops; // Idle counters
+	uint64_t idle_hits;
+	uint64_t idle_skipped;
+	uint64_t hash;
+	uint8_t *serial;
+	uint32_t serial_count;
+	const char *status;
+	double seconds;
+}Batch_Job;
+
+// Jobs shared by the workers, each job is only written by the worker running it
+typedef struct{
+	const char *bios_path;
+	uint8_t vm_flags; // VM_INIT_*
+	Idle *idle; // idle loop rules copied to every job VM
+	Batch_Job *jobs;
+	uint32_t count;
+}Batch;
+
+static char* batch_Copy(const char *str){
+	char *copy = NULL;
+
+	if (!str || !strcmp(str, "-"))
+		return NULL;
+	copy = (char*)malloc(strlen(str) + 1);
+	if (copy)
+		strcpy(copy, str);
+	return copy;
+}
+
+// Read job list, returns number of jobs or -1
+static int32_t batch_LoadJobs(Batch *pBatch, const char *path){
+	FILE *f = NULL;
+	char line[BATCH_LINE_SIZE], rom[BATCH_LINE_SIZE], input[BATCH_LINE_SIZE], dump[BATCH_LINE_SIZE];
+	uint32_t size = 0, frames;
+	Batch_Job *jobs = NULL, *job;
+	int fields;
+
+	f = fopen(path, "r");
+	if (!f)
+		return -1;
+	while (fgets(line, sizeof(line), f)){
+		if (strchr(line, '#'))
+			*strchr(line, '#') = '\0';
+		fields = sscanf(line, "%s %s %u %s", rom, input, &frames, dump);
+		if (fields < 3)
+			continue;
+		if (pBatch->count == size){
+			size = size ? size * 2 : 64;
+			jobs = (Batch_Job*)realloc(pBatch->jobs, size * sizeof(Batch_Job));
+			if (!jobs)
+				break;
+			pBatch->jobs = jobs;
+		}
+		job = &pBatch->jobs[pBatch->count++];
+		memset(job, 0, sizeof(Batch_Job));
+		job->rom = batch_Copy(rom);
+		job->input = batch_Copy(input);
+		job->dump = batch_Copy(fields == 4 ? dump : NULL);
+		job->frames = frames;
+		job->status = "not run";
+	}
+	fclose(f);
+	return pBatch->count;
+}
+
+// Read input script, returns number of entries or -1
+static int32_t batch_LoadInput(const char *path, Batch_Input **ppInput){
+	FILE *f = NULL;
+	char line[BATCH_LINE_SIZE];
+	unsigned int frame, buttons;
+	uint32_t size = 0, count = 0;
+	Batch_Input *input = NULL, *grown;
+
+	*ppInput = NULL;
+	f = fopen(path, "r");
+	if (!f)
+		return -1;
+	while (fgets(line, sizeof(line), f)){
+		if (sscanf(line, " %u %x", &frame, &buttons) != 2)
+			continue;
+		if (count == size){
+			size = size ? size * 2 : 64;
+			grown = (Batch_Input*)realloc(input, size * sizeof(Batch_Input));
+			if (!grown)
+				break;
+			input = grown;
+		}
+		input[count].frame = frame;
+		input[count].buttons = buttons;
+		count++;
+	}
+	fclose(f);
+	*ppInput = input;
+	return count;
+}
+
+// Pool task, run job idx in a VM of its own
+static void batch_Run(void *pArg, uint32_t idx){
+	Batch *batch = (Batch*)pArg;
+	Batch_Job *job = &batch->jobs[idx];
+	Batch_Input *input = NULL;
+	int32_t inputs = 0, next = 0;
+	struct timespec start, end;
+	Serial_Out *out = NULL;
+	VM *vm = NULL;
+	uint32_t frame;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (job->input && (inputs = batch_LoadInput(job->input, &input)) < 0){
+		job->status = "input script not found";
+		return;
+	}
+	vm = vm_Init(batch->vm_flags);
+	if (!vm){
+		job->status = "out of memory";
+		free(input);
+		return;
+	}
+	if (vm_LoadBios(vm, batch->bios_path) != 0)
+		job->status = "bios not loaded";
+	else if (job->rom && vm_LoadRom(vm, job->rom) != 0)
+		job->status = "rom not loaded";
+	else if (!job->rom && vm_WriteLogo(vm) != 0)
+		job->status = "logo not written";
+	else if ((out = serial_OutInit(BATCH_SERIAL_SIZE)) == NULL)
+		job->status = "out of memory";
+	if (!out){
+		vm_Quit(vm);
+		free(input);
+		return;
+	}
+	vm->cpu->serial_out = out;
+	if (vm->cpu->idle)
+		memcpy(vm->cpu->idle->io, batch->idle->io, sizeof(batch->idle->io));
+
+	for (frame = 0; frame < job->frames; frame++){
+		while (next < inputs && input[next].frame <= frame)
+			vm_SetButtons(vm, input[next++].buttons);
+		vm_RunFrame(vm);
+	}
+
+	job->cycles = vm->cpu->clock_cycle;
+	if (vm->cpu->idle){
+		job->idle_loops = vm->cpu->idle->loops;
+		job->idle_hits = vm->cpu->idle->hits;
+		job->idle_skipped = vm->cpu->idle->skipped;
+	}
+	job->hash = vm_HashVideo(vm);
+	job->serial = (uint8_t*)malloc(out->count);
+	if (job->serial){
+		memcpy(job->serial, out->data, out->count);
+		job->serial_count = out->count;
+	}
+	job->status = "ok";
+	if (job->dump && vm_DumpRam(vm, job->dump) != 0)
+		job->status = "ram dump not written";
+	vm_Quit(vm);
+	free(input);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	job->seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	return;
+}
+
+// Serial output as a C string
+static void batch_PrintSerial(FILE *f, const Batch_Job *pJob){
+	uint32_t i;
+	uint8_t c;
+
+	fputc('"', f);
+	for (i = 0; i < pJob->serial_count; i++){
+		c = pJob->serial[i];
+		if (c == '\n')
+			fprintf(f, "\\n");
+		else if (c == '"' || c == '\\')
+			fprintf(f, "\\%c", c);
+		else if (c < 0x20 || c > 0x7E)
+			fprintf(f, "\\x%02X", c);
+		else
+			fputc(c, f);
+	}
+	fputc('"', f);
+	return;
+}
+
+static void batch_Report(const Batch *pBatch, FILE *f){
+	const Batch_Job *job;
+	uint32_t i;
+
+	fprintf(f, "# rom\tframes\tcycles\tidle_loops\tidle_hits\tidle_skipped\tvideo_hash\tserial\tstatus\tseconds\n");
+	for (i = 0; i < pBatch->count; i++){
+		job = &pBatch->jobs[i];
+		fprintf(f, "%s\t%u\t%llu\t%llu\t%llu\t%llu\t%016llX\t", job->rom ? job->rom : "-", job->frames,
+			(unsigned long long)job->cycles, (unsigned long long)job->idle_loops, (unsigned long long)job->idle_hits,
+			(unsigned long long)job->idle_skipped, (unsigned long long)job->hash);
+		batch_PrintSerial(f, job);
+		fprintf(f, "\t%s\t%.3f\n", job->status, job->seconds);
+	}
+	return;
+}
+
+static void batch_Free(Batch *pBatch){
+	uint32_t i;
+
+	for (i = 0; i < pBatch->count; i++){
+		free(pBatch->jobs[i].rom);
+		free(pBatch->jobs[i].input);
+		free(pBatch->jobs[i].dump);
+		free(pBatch->jobs[i].serial);
+	}
+	free(pBatch->jobs);
+	idle_Free(pBatch->idle);
+	return;
+}
+
+static void batch_Usage(const char *name){
+	printf("Usage: %s [-b bios] [-o report] [-w workers] [-H] [-i|-I addr] <job list>\n", name);
+	printf("\t-b <file>\tBIOS image, bios/bios.gb by default\n");
+	printf("\t-o <file>\treport, stdout by default\n");
+	printf("\t-w <n>\t\tworker threads, one per core by default\n");
+	printf("\t-H\t\tVM memory on huge pages\n");
+	printf("\t-i, -I <addr>\tallow or forbid an IO port in idle loops, hex or all\n");
+	return;
+}
+
+int main(int argc, char *argv[]){
+	Batch batch;
+	const char *report_path = NULL, *list_path = NULL;
+	uint32_t workers = 0, steals = 0, i;
+	uint64_t cycles = 0;
+	struct timespec start, end;
+	double seconds;
+	FILE *report = stdout;
+
+	memset(&batch, 0, sizeof(Batch));
+	batch.bios_path = "bios/bios.gb";
+	batch.idle = idle_Init();
+	if (!batch.idle){
+		printf("Out of memory\n");
+		return -1;
+	}
+	for (i = 1; i < (uint32_t)argc; i++){
+		if (!strcmp(argv[i], "-b") && i + 1 < (uint32_t)argc)
+			batch.bios_path = argv[++i];
+		else if (!strcmp(argv[i], "-o") && i + 1 < (uint32_t)argc)
+			report_path = argv[++i];
+		else if (!strcmp(argv[i], "-w") && i + 1 < (uint32_t)argc)
+			workers = strtoul(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "-H"))
+			batch.vm_flags |= VM_INIT_HUGE_PAGES;
+		else if ((!strcmp(argv[i], "-i") || !strcmp(argv[i], "-I")) && i + 1 < (uint32_t)argc){
+			if (idle_AllowRule(batch.idle, argv[i + 1], argv[i][1] == 'i') != 0){
+				printf("Bad idle loop rule %s\n", argv[i + 1]);
+				batch_Free(&batch);
+				return -1;
+			}
+			i++;
+		}else if (argv[i][0] != '-' && !list_path)
+			list_path = argv[i];
+		else{
+			batch_Usage(argv[0]);
+			batch_Free(&batch);
+			return -1;
+		}
+	}
+	if (!list_path){
+		batch_Usage(argv[0]);
+		batch_Free(&batch);
+		return -1;
+	}
+	if (batch_LoadJobs(&batch, list_path) < 0){
+		printf("Could not read job list %s\n", list_path);
+		batch_Free(&batch);
+		return -1;
+	}
+	if (!workers)
+		workers = pool_Cores();
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (pool_Run(batch_Run, &batch, batch.count, workers, &steals) != 0){
+		printf("Could not start thread pool\n");
+		batch_Free(&batch);
+		return -1;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	if (report_path && (report = fopen(report_path, "w")) == NULL){
+		printf("Could not write report %s\n", report_path);
+		report = stdout;
+	}
+	batch_Report(&batch, report);
+	if (report != stdout)
+		fclose(report);
+
+	for (i = 0; i < batch.count; i++)
+		cycles += batch.jobs[i].cycles;
+	seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	fprintf(report_path ? stdout : stderr, "%u jobs on %u workers (%u steals), %llu clock cycles in %.3f s, %.1fx real time\n",
+		batch.count, workers, steals, (unsigned long long)cycles, seconds,
+		seconds > 0 ? cycles / (seconds * CPU_CLOCK_HZ) : 0.0);
+	batch_Free(&batch);
+	return 0;
+}
@@ -0,0 +1,100 @@
+#include "block.h"
+
+Block_Cache* block_Init(void){
+	Block_Cache *cache = NULL;
+	cache = (Block_Cache*)calloc(1, sizeof(Block_Cache));
+	return cache;
+}
+
+void block_Free(Block_Cache *pCache){
+	free(pCache);
+	return;
+}
+
+void block_Flush(Block_Cache *pCache){
+	uint32_t i;
+	for (i = 0; i < BLOCK_CACHE_SIZE; i++)
+		pCache->blocks[i].code = NULL;
+	memset(pCache->code, 0, sizeof(pCache->code));
+	pCache->stale = 1;
+	return;
+}
+
+void block_FlushRam(Block_Cache *pCache){
+	const uint8_t *code;
+	uint32_t i;
+	uint8_t j;
+
+	for (j = 0; j < BLOCK_CODE_PAGES && !pCache->code[j].active; j++);
+	if (j == BLOCK_CODE_PAGES)
+		return; // no block in RAM
+	for (i = 0; i < BLOCK_CACHE_SIZE; i++){
+		code = pCache->blocks[i].code;
+		if (!code)
+			continue;
+		for (j = 0; j < BLOCK_CODE_PAGES; j++){
+			if (pCache->code[j].active && code >= pCache->code[j].page && code < pCache->code[j].page + MEM_PAGE_SIZE){
+				pCache->blocks[i].code = NULL;
+				break;
+			}
+		}
+	}
+	memset(pCache->code, 0, sizeof(pCache->code));
+	pCache->stale = 1;
+	return;
+}
+
+Block_CodePage* block_FindCodePage(Block_Cache *pCache, const uint8_t *page){
+	uint8_t i;
+	for (i = 0; i < BLOCK_CODE_PAGES; i++)
+		if (pCache->code[i].page == page)
+			return &pCache->code[i];
+	return NULL;
+}
+
+Block_CodePage* block_AddCodePage(Block_Cache *pCache, const uint8_t *page){
+	Block_CodePage *code = block_FindCodePage(pCache, page);
+	uint8_t i;
+
+	if (!code){
+		// Take an empty slot or recycle a page without blocks
+		for (i = 0; i < BLOCK_CODE_PAGES && !code; i++)
+			if (!pCache->code[i].page || (!pCache->code[i].active && pCache->code[i].drops < BLOCK_SMC_LIMIT))
+				code = &pCache->code[i];
+		if (!code)
+			return NULL;
+		memset(code, 0, sizeof(Block_CodePage));
+		code->page = page;
+	}
+	if (code->drops >= BLOCK_SMC_LIMIT)
+		return NULL;
+	return code;
+}
+
+void block_MarkCode(Block_CodePage *pCode, uint8_t offset, uint16_t size){
+	uint16_t i;
+	for (i = offset; i < offset + size && i < MEM_PAGE_SIZE; i++)
+		pCode->used[i >> 3] |= 1 << (i & 7);
+	pCode->active = 1;
+	return;
+}
+
+uint8_t block_Write(Block_Cache *pCache, Block_CodePage *pCode, uint8_t offset){
+	uint32_t i;
+	const uint8_t *code;
+
+	if (!pCode->active || !(pCode->used[offset >> 3] & (1 << (offset & 7))))
+		return 0; // data next to code
+
+	for (i = 0; i < BLOCK_CACHE_SIZE; i++){
+		code = pCache->blocks[i].code;
+		if (code >= pCode->page && code < pCode->page + MEM_PAGE_SIZE)
+			pCache->blocks[i].code = NULL;
+	}
+	memset(pCode->used, 0, sizeof(pCode->used));
+	pCode->active = 0;
+	if (pCode->drops < UINT8_MAX)
+		pCode->drops++;
+	pCache->stale = 1;
+	return 1;
+}
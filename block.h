@@ -0,0 +1,92 @@
+#ifndef _BLOCK_H
+#define _BLOCK_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memory_map.h"
+
+/*
+
+	Decoded block cache
+
+	Straight-line runs of instructions are decoded once into micro-ops
+	(opcode table index + immediate operand) and replayed by the Cpu
+	without fetching and decoding them again through the page table.
+
+	Blocks are keyed by the host address of their first instruction, so
+	the same PC in another ROM bank or under the BIOS overlay is a different
+	block. A block never crosses a 256 byte page and ends on control flow.
+
+	Blocks decoded from RAM register their page as a code page, the Cpu
+	traps writes to it and drops the blocks covering a written byte. Pages
+	rewritten over and over (self-modifying loops) stop being cached.
+
+*/
+
+#define BLOCK_MAX_OPS (32)
+#define BLOCK_CACHE_SIZE (0x800) // number of blocks, power of 2
+#define BLOCK_CODE_PAGES (16) // RAM pages holding cached code
+#define BLOCK_SMC_LIMIT (8) // code writes before a page is no longer cached
+
+// Micro-op
+typedef struct{
+	uint16_t idx; // Cpu opcode table index, page1 offset by 0x100
+	uint16_t operand;
+}Block_Op;
+
+// Decoded block
+typedef struct{
+	const uint8_t *code; // host address of first instruction, NULL for an empty slot
+	uint8_t count; // number of micro-ops
+	uint8_t heat; // interpreted runs, compiled by the Jit when it reaches its threshold
+	uint16_t cycles; // clock cycles of all micro-ops
+	void *native; // Jit compiled code, NULL until compiled
+	uint16_t idle_cycles; // clock cycles of one iteration when the block is an idle loop, 0 otherwise
+	Block_Op ops[BLOCK_MAX_OPS];
+}Block;
+
+// RAM page holding cached code
+typedef struct{
+	const uint8_t *page; // host address of page, NULL for an empty slot
+	uint8_t active; // blocks were decoded from page, writes to it are trapped
+	uint8_t drops; // times blocks were dropped by a code write
+	uint8_t used[MEM_PAGE_SIZE / 8]; // bitmap of bytes decoded into blocks
+}Block_CodePage;
+
+// Block cache
+typedef struct{
+	Block blocks[BLOCK_CACHE_SIZE];
+	Block_CodePage code[BLOCK_CODE_PAGES];
+	uint8_t stale; // set when cached code or the memory map changed or an interrupt is pending, ends the running block
+	uint64_t hits;
+	uint64_t misses;
+}Block_Cache;
+
+// Initialize and return an empty block cache
+Block_Cache* block_Init(void);
+// Free a block cache
+void block_Free(Block_Cache *pCache);
+// Drop every block, use cpu_FlushBlocks to also restore RAM page writes
+void block_Flush(Block_Cache *pCache);
+// Drop blocks decoded from RAM, ROM blocks stay valid
+void block_FlushRam(Block_Cache *pCache);
+
+// Returns code page slot of a host page, NULL if no block was decoded from it
+Block_CodePage* block_FindCodePage(Block_Cache *pCache, const uint8_t *page);
+// Returns code page slot for a host page, allocates it if needed,
+// NULL if full or the page is rewritten too often to be cached
+Block_CodePage* block_AddCodePage(Block_Cache *pCache, const uint8_t *page);
+// Mark bytes [offset; offset + size[ of a code page as decoded
+void block_MarkCode(Block_CodePage *pCode, uint8_t offset, uint16_t size);
+// Drop blocks decoded from a code page if byte at offset is code,
+// returns 1 when they were dropped and writes no longer need trapping
+uint8_t block_Write(Block_Cache *pCache, Block_CodePage *pCode, uint8_t offset);
+
+// Returns slot of block starting at a host address
+static inline Block* block_Get(Block_Cache *pCache, const uint8_t *code){
+	uintptr_t key = (uintptr_t)code;
+	return &pCache->blocks[(key ^ (key >> 11)) & (BLOCK_CACHE_SIZE - 1)];
+}
+
+#endif
@@ -0,0 +1,194 @@
+#include "callprof.h"
+
+CallProf* callprof_Init(const char *path, uint32_t period){
+	CallProf *prof = (CallProf*)calloc(1, sizeof(CallProf));
+	if (!prof)
+		return NULL;
+	prof->nodes = (CallProf_Node*)calloc(CALLPROF_NODES, sizeof(CallProf_Node));
+	prof->path = (char*)malloc(strlen(path) + 1);
+	if (!prof->nodes || !prof->path){
+		callprof_Free(prof);
+		return NULL;
+	}
+	strcpy(prof->path, path);
+	prof->period = period ? period : CALLPROF_PERIOD;
+	prof->count = 1; // root
+	return prof;
+}
+
+static int callprof_CompareSymbols(const void *a, const void *b){
+	const CallProf_Symbol *x = (const CallProf_Symbol*)a, *y = (const CallProf_Symbol*)b;
+	if (x->bank != y->bank)
+		return x->bank - y->bank;
+	return x->address - y->address;
+}
+
+int32_t callprof_LoadSymbols(CallProf *pProf, const char *path){
+	FILE *f = NULL;
+	char line[256];
+	unsigned int bank, address;
+	uint32_t size = 0;
+	CallProf_Symbol *symbols = NULL, sym;
+
+	f = fopen(path, "r");
+	if (!f)
+		return -1;
+	while (fgets(line, sizeof(line), f)){
+		// "BB:AAAA Name", ';' starts a comment
+		if (sscanf(line, " %x:%x %63[^; \t\r\n]", &bank, &address, sym.name) != 3)
+			continue;
+		if (pProf->symbol_count == size){
+			size = size ? size * 2 : 256;
+			symbols = (CallProf_Symbol*)realloc(pProf->symbols, size * sizeof(CallProf_Symbol));
+			if (!symbols)
+				break;
+			pProf->symbols = symbols;
+		}
+		sym.bank = bank;
+		sym.address = address;
+		pProf->symbols[pProf->symbol_count++] = sym;
+	}
+	fclose(f);
+	qsort(pProf->symbols, pProf->symbol_count, sizeof(CallProf_Symbol), callprof_CompareSymbols);
+	return pProf->symbol_count;
+}
+
+void callprof_Start(Cpu *pCpu, CallProf *pProf){
+	pCpu->callprof = pProf;
+	pProf->depth = 0;
+	sched_Add(&pCpu->sched, SCHED_EVENT_PROFILE, pCpu->clock_cycle + pProf->period);
+	return;
+}
+
+// ROM bank of address, 0 outside of the switchable bank
+static uint16_t callprof_Bank(const Cpu *pCpu, uint16_t address){
+	const Memory *mem = &pCpu->map[MAP_ROM_BANK_SWITCH].mem;
+	if (address < MEM_ROM_SWITCH_BANK_OFFSET || address >= MEM_VIDEO_RAM_OFFSET)
+		return 0;
+	return mem->start_idx / mem->bank_size;
+}
+
+// Returns callee node of parent, created on first call
+static uint32_t callprof_Callee(CallProf *pProf, uint32_t parent, uint16_t bank, uint16_t address){
+	CallProf_Node *node;
+	uint32_t i;
+
+	for (i = pProf->nodes[parent].child; i; i = pProf->nodes[i].sibling)
+		if (pProf->nodes[i].address == address && pProf->nodes[i].bank == bank)
+			return i;
+	if (pProf->count == CALLPROF_NODES)
+		return 0;
+	i = pProf->count++;
+	node = &pProf->nodes[i];
+	node->parent = parent;
+	node->bank = bank;
+	node->address = address;
+	node->sibling = pProf->nodes[parent].child;
+	pProf->nodes[parent].child = i;
+	return i;
+}
+
+void callprof_Call(Cpu *pCpu, uint16_t address){
+	CallProf *prof = pCpu->callprof;
+	uint32_t node;
+
+	if (prof->depth + 1 == CALLPROF_DEPTH){
+		prof->lost++;
+		return;
+	}
+	node = callprof_Callee(prof, prof->stack[prof->depth], callprof_Bank(pCpu, address), address);
+	if (!node){
+		prof->lost++;
+		return;
+	}
+	prof->depth++;
+	prof->stack[prof->depth] = node;
+	prof->sp[prof->depth] = pCpu->SP;
+	return;
+}
+
+void callprof_Return(Cpu *pCpu){
+	CallProf *prof = pCpu->callprof;
+
+	// Frames left without RET (stack reset, return address popped) are below SP
+	while (prof->depth && prof->sp[prof->depth] <= pCpu->SP)
+		prof->depth--;
+	return;
+}
+
+void callprof_Event(Cpu *pCpu, uint64_t deadline){
+	CallProf *prof = pCpu->callprof;
+
+	prof->nodes[prof->stack[prof->depth]].samples++;
+	prof->samples++;
+	sched_Add(&pCpu->sched, SCHED_EVENT_PROFILE, deadline + prof->period);
+	return;
+}
+
+// Writes frame name, symbol at or before address in the same bank
+static void callprof_PrintFrame(const CallProf *pProf, FILE *f, const CallProf_Node *pNode){
+	const CallProf_Symbol *sym = NULL;
+	uint32_t lo = 0, hi = pProf->symbol_count, mid;
+	CallProf_Symbol key;
+
+	key.bank = pNode->bank;
+	key.address = pNode->address;
+	while (lo < hi){ // first symbol past key
+		mid = (lo + hi) / 2;
+		if (callprof_CompareSymbols(&pProf->symbols[mid], &key) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo)
+		sym = &pProf->symbols[lo - 1];
+	if (!sym || sym->bank != pNode->bank)
+		fprintf(f, "%02X:%04X", pNode->bank, pNode->address);
+	else if (sym->address == pNode->address)
+		fprintf(f, "%s", sym->name);
+	else
+		fprintf(f, "%s+%X", sym->name, pNode->address - sym->address);
+	return;
+}
+
+static void callprof_PrintStack(const CallProf *pProf, FILE *f, uint32_t node){
+	if (pProf->nodes[node].parent){
+		callprof_PrintStack(pProf, f, pProf->nodes[node].parent);
+		fputc(';', f);
+	}
+	callprof_PrintFrame(pProf, f, &pProf->nodes[node]);
+	return;
+}
+
+void callprof_Report(const CallProf *pProf){
+	FILE *f = NULL;
+	uint32_t i;
+
+	f = fopen(pProf->path, "w");
+	if (!f){
+		printf("Could not write call stack profile %s\n", pProf->path);
+		return;
+	}
+	// Samples outside of any call are reported under "root"
+	if (pProf->nodes[0].samples)
+		fprintf(f, "root %llu\n", (unsigned long long)pProf->nodes[0].samples);
+	for (i = 1; i < pProf->count; i++){
+		if (!pProf->nodes[i].samples)
+			continue;
+		fprintf(f, "root;");
+		callprof_PrintStack(pProf, f, i);
+		fprintf(f, " %llu\n", (unsigned long long)pProf->nodes[i].samples);
+	}
+	fclose(f);
+	if (pProf->lost)
+		printf("Call stack profile: %llu calls not followed\n", (unsigned long long)pProf->lost);
+	return;
+}
+
+void callprof_Free(CallProf *pProf){
+	free(pProf->nodes);
+	free(pProf->symbols);
+	free(pProf->path);
+	free(pProf);
+	return;
+}
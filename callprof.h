@@ -0,0 +1,86 @@
+#ifndef _CALLPROF_H
+#define _CALLPROF_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpu.h"
+
+/*
+
+	Guest call stack profiler
+
+	A shadow call stack follows CALL, RST and interrupt entry, RET and
+	RETI pop it. Frames are keyed on ROM bank and address of the called
+	code and stored as a call tree. A scheduler event samples the current
+	frame every period clock cycles, so the samples are emulated time,
+	native blocks and idle skipping included.
+
+	Return addresses are matched on SP: a return pops every frame at or
+	below the returning SP, a return with no frame there (pushed address
+	then RET) pops nothing.
+
+	vm_Quit writes the tree in folded stack format, one line per stack
+	"frame;frame;frame samples", read by flamegraph tools. Frames are
+	named from a .sym file ("BB:AAAA Name" lines) when one is loaded,
+	BB:AAAA otherwise.
+
+*/
+
+#define CALLPROF_PERIOD (1024) // default sample period in clock cycles
+#define CALLPROF_NODES (0x10000) // call tree size, calls past it are merged in their caller
+#define CALLPROF_DEPTH (256) // shadow stack size
+#define CALLPROF_NAME_SIZE (64)
+
+// Call tree node, one per distinct call path
+typedef struct{
+	uint32_t parent;
+	uint32_t child; // first callee, 0 if none (node 0 is the root)
+	uint32_t sibling; // next callee of parent
+	uint16_t bank;
+	uint16_t address;
+	uint64_t samples;
+}CallProf_Node;
+
+// Symbol loaded from a .sym file
+typedef struct{
+	uint16_t bank;
+	uint16_t address;
+	char name[CALLPROF_NAME_SIZE];
+}CallProf_Symbol;
+
+// Call stack profiler structure
+typedef struct CallProf{
+	CallProf_Node *nodes;
+	uint32_t count; // nodes used
+	uint32_t stack[CALLPROF_DEPTH]; // node of each frame, stack[0] is the root
+	uint16_t sp[CALLPROF_DEPTH]; // SP holding the return address of each frame
+	uint16_t depth;
+	uint32_t period;
+	uint64_t samples;
+	uint64_t lost; // calls not followed, shadow stack or call tree full
+	CallProf_Symbol *symbols; // sorted on bank and address
+	uint32_t symbol_count;
+	char *path; // folded stack output
+}CallProf;
+
+// Initialize and return a profiler writing folded stacks to path, period 0 uses CALLPROF_PERIOD
+CallProf* callprof_Init(const char *path, uint32_t period);
+// Load frame names from a .sym file, returns number of symbols or -1
+int32_t callprof_LoadSymbols(CallProf *pProf, const char *path);
+// Attach profiler to Cpu, empty its shadow stack and schedule the next sample
+void callprof_Start(Cpu *pCpu, CallProf *pProf);
+// Call to address, SP holds the return address
+void callprof_Call(Cpu *pCpu, uint16_t address);
+// Return from the frame at SP, before the return address is popped
+void callprof_Return(Cpu *pCpu);
+// SCHED_EVENT_PROFILE handler, sample current frame
+void callprof_Event(Cpu *pCpu, uint64_t deadline);
+// Write folded stacks
+void callprof_Report(const CallProf *pProf);
+// Free profiler
+void callprof_Free(CallProf *pProf);
+
+#endif
@@ -0,0 +1,154 @@
+#include "cli.h"
+
+uint8_t cli_VmFlags(int argc, char *argv[]){
+	uint8_t flags = 0;
+	int i;
+
+	for (i = 1; i < argc; i++)
+		if (strcmp(argv[i], "-H") == 0)
+			flags |= VM_INIT_HUGE_PAGES;
+	return flags;
+}
+
+int8_t cli_Parse(Cli *pCli, VM *pVm, int argc, char *argv[]){
+	CallProf *callprof = NULL;
+	const char *sym_path = NULL;
+	uint32_t rewind_seconds = 0, rewind_mb = 0;
+	int i;
+
+	pCli->bios_path = "bios/bios.gb";
+	pCli->rom_path = NULL;
+	pCli->frames = 0;
+	pCli->load_path = NULL;
+	pCli->save_path = NULL;
+	pCli->trace = NULL;
+	pCli->jit = NULL;
+	pCli->rewind = NULL;
+	pCli->sram_path = NULL;
+	pCli->sram_interval_ms = 0;
+
+	for (i = 1; i < argc; i++){
+		if (strcmp(argv[i], "-b") == 0 && i + 1 < argc){
+			pCli->bios_path = argv[++i];
+		}else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc){
+			pCli->frames = strtoul(argv[++i], NULL, 0);
+		}else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc){
+			pCli->trace = trace_Open(argv[++i], 0x100000);
+			if (!pCli->trace)
+				printf("Could not open trace file %s\n", argv[i]);
+			pVm->cpu->trace = pCli->trace;
+		}else if (strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "-J") == 0){
+			pCli->jit = jit_Init(argv[i][1] == 'J');
+			if (!pCli->jit)
+				printf("Jit not available on this host\n");
+			pVm->cpu->jit = pCli->jit;
+		}else if (strcmp(argv[i], "-p") == 0){
+			pVm->cpu->prof = prof_Init(NULL);
+		}else if (strcmp(argv[i], "-P") == 0 && i + 1 < argc){
+			pVm->cpu->prof = prof_Init(argv[++i]);
+		}else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc){
+			callprof = callprof_Init(argv[++i], 0);
+		}else if (strcmp(argv[i], "-y") == 0 && i + 1 < argc){
+			sym_path = argv[++i];
+		}else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc){
+			pCli->load_path = argv[++i];
+		}else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc){
+			pCli->save_path = argv[++i];
+		}else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc){
+			rewind_seconds = strtoul(argv[++i], NULL, 0);
+		}else if (strcmp(argv[i], "-R") == 0 && i + 1 < argc){
+			rewind_mb = strtoul(argv[++i], NULL, 0);
+		}else if (strcmp(argv[i], "-S") == 0 && i + 1 < argc){
+			pCli->sram_path = argv[++i];
+		}else if (strcmp(argv[i], "-F") == 0 && i + 1 < argc){
+			pCli->sram_interval_ms = strtoul(argv[++i], NULL, 0);
+		}else if ((strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "-I") == 0) && i + 1 < argc){
+			if (pVm->cpu->idle && idle_AllowRule(pVm->cpu->idle, argv[i + 1], argv[i][1] == 'i') != 0){
+				printf("Bad idle loop rule %s\n", argv[i + 1]);
+				if (callprof)
+					callprof_Free(callprof);
+				return -1;
+			}
+			i++;
+		}else if (strcmp(argv[i], "-H") == 0){
+			// taken by cli_VmFlags
+		}else if (argv[i][0] != '-' && !pCli->rom_path){
+			pCli->rom_path = argv[i];
+		}else{
+			printf("Unknown option %s\n", argv[i]);
+			if (callprof)
+				callprof_Free(callprof);
+			return -1;
+		}
+	}
+
+	if (rewind_seconds){
+		pCli->rewind = rewind_Init((uint64_t)rewind_seconds * CPU_CLOCK_HZ / LCD_FRAME_CYCLES, (size_t)rewind_mb << 20, 0);
+		if (!pCli->rewind)
+			printf("Could not allocate rewind buffer\n");
+	}
+	if (callprof){
+		if (sym_path && callprof_LoadSymbols(callprof, sym_path) < 0)
+			printf("Could not read symbol file %s\n", sym_path);
+		callprof_Start(pVm->cpu, callprof);
+	}
+	return 0;
+}
+
+void cli_Usage(const char *name){
+	printf("Usage: %s [options] [cartridge]\n", name);
+	printf("  -b <file>     BIOS image (bios/bios.gb)\n");
+	printf("  -n <frames>   frames to run, 0 runs until exit\n");
+	printf("  -t <file>     binary execution trace\n");
+	printf("  -j, -J        native code for hot blocks, -J verifies it\n");
+	printf("  -p, -P <file> opcode profile, table or CSV\n");
+	printf("  -c <file>     guest call stacks in folded format\n");
+	printf("  -y <file>     .sym file for call stack frames\n");
+	printf("  -H            VM memory on huge pages\n");
+	printf("  -i, -I <addr> allow or forbid an IO port in idle loops, hex or all\n");
+	printf("  -l <file>     load save state before running\n");
+	printf("  -s <file>     save state on exit\n");
+	printf("  -r <seconds>  rewind buffer, hold Backspace to step back\n");
+	printf("  -R <MB>       rewind buffer memory (8)\n");
+	printf("  -S <file>     battery save file, state loads and rewind write to it\n");
+	printf("  -F <ms>       save file flush interval (1000)\n");
+	return;
+}
+
+int8_t cli_LoadRom(const Cli *pCli, VM *pVm){
+	if (!pCli->rom_path)
+		return vm_WriteLogo(pVm);
+	if (vm_LoadRom(pVm, pCli->rom_path) != 0){
+		printf("Could not load cartridge %s\n", pCli->rom_path);
+		return -1;
+	}
+	if (pCli->sram_path && !sram_Open(pVm, pCli->sram_path, pCli->sram_interval_ms))
+		printf("Could not map save file %s, no cartridge RAM or huge page memory\n", pCli->sram_path);
+	return 0;
+}
+
+int8_t cli_LoadState(const Cli *pCli, VM *pVm){
+	if (!pCli->load_path || vm_LoadStateFile(pVm, pCli->load_path) == 0)
+		return 0;
+	printf("Could not load state %s\n", pCli->load_path);
+	return -1;
+}
+
+void cli_SaveState(const Cli *pCli, const VM *pVm){
+	if (pCli->save_path && vm_SaveStateFile(pVm, pCli->save_path) != 0)
+		printf("Could not save state %s\n", pCli->save_path);
+	return;
+}
+
+void cli_Free(Cli *pCli){
+	if (pCli->rewind)
+		rewind_Free(pCli->rewind);
+	if (pCli->trace)
+		trace_Free(pCli->trace);
+	if (pCli->jit){
+		printf("Jit: %llu blocks, %llu verified, %llu mismatches\n", (unsigned long long)pCli->jit->compiled,
+			(unsigned long long)pCli->jit->verified, (unsigned long long)pCli->jit->mismatches);
+		jit_Free(pCli->jit);
+	}
+	return;
+}
@@ -0,0 +1,68 @@
+#ifndef _CLI_H
+#define _CLI_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "vm.h"
+#include "jit.h"
+#include "rewind.h"
+#include "sram.h"
+
+/*
+
+	Command line options shared by the front ends
+
+	[options] [cartridge], the bios runs on the Nintendo logo alone
+	when no cartridge is given
+
+	-b <file>	BIOS image, bios/bios.gb by default
+	-n <frames>	frames to run, 0 runs until the front end exits
+	-t <file>	binary execution trace, decode with tools/trace_decode
+	-j, -J		native code for hot blocks, -J checks it against the interpreter
+	-p, -P <file>	opcode profile printed or written as CSV on exit
+	-c <file>	guest call stacks in folded format on exit
+	-y <file>	.sym file naming call stack frames
+	-H		VM memory on huge pages
+	-i, -I <addr>	allow or forbid polling of an IO port in skipped idle loops,
+			a hex address or all, -I all runs every idle loop
+	-l <file>	load a save state before running
+	-s <file>	save state on exit
+	-r <seconds>	rewind buffer, Backspace steps back in the window
+	-R <MB>		rewind buffer memory, 8 by default
+	-S <file>	battery save file mapped on cartridge RAM
+	-F <ms>		save file flush interval, 1000 by default
+
+*/
+
+// Parsed options and the debug objects they attached
+typedef struct{
+	const char *bios_path;
+	const char *rom_path; // cartridge, NULL for none
+	uint32_t frames;
+	const char *load_path; // save state loaded before running, NULL for none
+	const char *save_path; // save state written on exit, NULL for none
+	Trace *trace;
+	Jit *jit;
+	Rewind *rewind; // for the front end, NULL when off
+	const char *sram_path; // battery save file, NULL for none
+	uint32_t sram_interval_ms;
+}Cli;
+
+// Returns the vm_Init flags (VM_INIT_*) set by the options, read before the VM exists
+uint8_t cli_VmFlags(int argc, char *argv[]);
+// Parse options and attach trace, jit and profilers to the VM Cpu, returns -1 on a bad option
+int8_t cli_Parse(Cli *pCli, VM *pVm, int argc, char *argv[]);
+// Print option list
+void cli_Usage(const char *name);
+// Load the cartridge and map its -S save file, or write the logo alone to ROM when there is none, returns 0 on success
+int8_t cli_LoadRom(const Cli *pCli, VM *pVm);
+// Load the -l save state, returns 0 when there is none or it loaded
+int8_t cli_LoadState(const Cli *pCli, VM *pVm);
+// Write the -s save state, before vm_Quit
+void cli_SaveState(const Cli *pCli, const VM *pVm);
+// Report and free what the options attached, after vm_Quit
+void cli_Free(Cli *pCli);
+
+#endif
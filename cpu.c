@@ -1,30 +1,59 @@
+#include <pthread.h>
+
 #include "cpu.h"
 #include "opcode.h"
+#include "alu.h"
+#include "prof.h"
+#include "callprof.h"
+#include "snap.h"
+#include "mbc.h"
+#include "jit.h"
+#include "idle.h"
+#include "lcd.h"
+#include "serial.h"
+#include "joypad.h"
+#include "timer.h"
+
+// Opcode and ALU tables are shared by every Cpu, built by the first cpu_Init
+static pthread_once_t cpu_tables_once = PTHREAD_ONCE_INIT;
+
+static void cpu_InitTables(void){
+	cpu_InitOpcodeTable();
+	alu_Init();
+	return;
+}
 
 Cpu* cpu_Init(void){
 	Cpu *pCpu = NULL;
+	MemoryMap *map = NULL;
+
 	pCpu = (Cpu*)malloc(sizeof(Cpu));
-	if (!pCpu)
+	map = (MemoryMap*)malloc(sizeof(MemoryMap) * MEM_ADDRESS_SPACES);
+	if (!pCpu || !map){
+		free(pCpu);
+		free(map);
 		return NULL;
-	cpu_Reset(pCpu);
-	pCpu->map = NULL;
-	pCpu->map = (MemoryMap*)malloc(sizeof(MemoryMap) * MEM_ADDRESS_SPACES);
-	pCpu->reg[REG_B] = (union Cpu_Register*)&pCpu->B;
-	pCpu->reg[REG_C] = (union Cpu_Register*)&pCpu->C;
-	pCpu->reg[REG_D] = (union Cpu_Register*)&pCpu->D;
-	pCpu->reg[REG_E] = (union Cpu_Register*)&pCpu->E;
-	pCpu->reg[REG_H] = (union Cpu_Register*)&pCpu->H;
-	pCpu->reg[REG_L] = (union Cpu_Register*)&pCpu->L;
-	pCpu->reg[REG_A] = (union Cpu_Register*)&pCpu->A; // reg[7]
-	pCpu->reg[REG_F] = (union Cpu_Register*)&pCpu->F;
-	pCpu->dreg[REG_BC] = &pCpu->BC;
-	pCpu->dreg[REG_DE] = &pCpu->DE;
-	pCpu->dreg[REG_HL] = &pCpu->HL;
-	pCpu->dreg[REG_SP] = &pCpu->SP;
-	pCpu->dreg[REG_AF] = &pCpu->AF;
+	}
+	cpu_Setup(pCpu, map);
 	return pCpu;
 }
 
+void cpu_Setup(Cpu *pCpu, MemoryMap *pMap){
+	pthread_once(&cpu_tables_once, cpu_InitTables);
+	cpu_Reset(pCpu);
+	pCpu->trace = NULL;
+	pCpu->blocks = NULL;
+	pCpu->jit = NULL;
+	pCpu->idle = NULL;
+	pCpu->prof = NULL;
+	pCpu->callprof = NULL;
+	pCpu->snap = NULL;
+	pCpu->sram = NULL;
+	pCpu->serial_out = NULL;
+	pCpu->map = pMap;
+	return;
+}
+
 void cpu_Free(Cpu *pCpu){
 	free(pCpu->map);
 	free(pCpu);
@@ -34,15 +63,30 @@ void cpu_Free(Cpu *pCpu){
 
 void cpu_Reset(Cpu *pCpu){
 	pCpu->clock_cycle = 0;
-	pCpu->extended = 0;
 	pCpu->stop = 0;
 	pCpu->halt = 0;
+	pCpu->ime = 0;
+	pCpu->ime_delay = 0;
+	pCpu->int_pending = 0;
 	pCpu->AF = 0;
+	pCpu->flag_op = CPU_FLAGS_SYNC;
 	pCpu->BC = 0;
 	pCpu->DE = 0;
 	pCpu->HL = 0;
 	pCpu->PC = 0;
 	pCpu->SP = 0xFFFE; // Game Boy cpu manual p64
+	sched_Init(&pCpu->sched);
+	pCpu->div_base = 0;
+	pCpu->tima_base = 0;
+	pCpu->tima = 0;
+	pCpu->buttons = 0;
+	// No mapper until a cartridge is loaded (mbc_Init)
+	pCpu->mbc = MBC_NONE;
+	pCpu->mbc_ram_enable = 0;
+	pCpu->mbc_mode = 0;
+	pCpu->mbc_rom_bank = 1;
+	pCpu->mbc_ram_bank = 0;
+	pCpu->mbc_latch = 0xFF;
 	pCpu->sfr = (union Special_Register*)NULL;
 	return;
 }
@@ -57,52 +101,174 @@ void cpu_SetInterruptEnableRegister(Cpu *pCpu, uint8_t *pMem){
 	return;
 }
 
-uint8_t* cpu_GetByte(Cpu *pCpu){ // read byte at address_bus into data_bus, return pointer to byte in memory
-	uint8_t (*byte) = NULL;
-	MemoryMap *map = NULL;
+void cpu_UpdateInterrupt(Cpu *pCpu){
+	pCpu->int_pending = pCpu->ime_delay || (pCpu->ime && (pCpu->ie_reg->IE & pCpu->sfr->IF & INT_MASK));
+	// End the running block, the interrupt is serviced before the next instruction
+	if (pCpu->int_pending && pCpu->blocks)
+		pCpu->blocks->stale = 1;
+	return;
+}
 
-	// TODO : Bin search correct memory space ?
-	if (pCpu->address_bus < MEM_ROM_SWITCH_BANK_OFFSET){ // BIOS & ROM bank 0
-		if (pCpu->sfr->BIOS){ // BIOS disabled
-			map = &pCpu->map[MAP_ROM_BANK_0];
-		}else{
-			map = &pCpu->map[MAP_ROM_BIOS];
-		}
-	}else if (pCpu->address_bus < MEM_VIDEO_RAM_OFFSET){ // ROM bank switch
-		map = &pCpu->map[MAP_ROM_BANK_SWITCH];
-	}else if (pCpu->address_bus < MEM_RAM_SWITCH_OFFSET){ // VRAM
-		map = &pCpu->map[MAP_VRAM];
-	}else if (pCpu->address_bus < MEM_RAM_INTERNAL_OFFSET){ // RAM bank switch
-		map = &pCpu->map[MAP_RAM_BANK_SWITCH];
-	}else if (pCpu->address_bus < MEM_RAM_INTERNAL_ECHO_OFFSET){ // Internal RAM
-		map = &pCpu->map[MAP_RAM_INTERNAL];
-	}else if (pCpu->address_bus < MEM_SPRITE_ATTRI_OFFSET){ // Internal RAM echo
-		map = &pCpu->map[MAP_RAM_INTERNAL_ECHO];
-	}else if (pCpu->address_bus < MEM_UNUSABLE_OFFSET){ // Object attribute ram
-		map = &pCpu->map[MAP_OAM];
-	}else{
-		if (pCpu->address_bus < MEM_IO_PORTS_OFFSET){ // Unusable memory
-			DEBUG_PRINTF("Illegal address> $%04X\n", pCpu->address_bus);
-			return NULL;
+static void cpu_ProtectPages(Cpu *pCpu);
+static void cpu_UnprotectPage(Cpu *pCpu, const uint8_t *pPage);
+
+// Point the pages of an address range to a memory map, at the map current bank
+static void cpu_MapPages(Cpu *pCpu, uint8_t map_idx, uint16_t address, uint32_t size, uint8_t writable){
+	MemoryMap *map = &pCpu->map[map_idx];
+	uint8_t *data = &map->mem.data[(address - map->offset) + map->mem.start_idx];
+	uint16_t page;
+
+	for (page = address / MEM_PAGE_SIZE; page < (address + size) / MEM_PAGE_SIZE; page++, data += MEM_PAGE_SIZE){
+		pCpu->read_page[page] = data;
+		pCpu->write_page[page] = writable ? data : NULL;
+	}
+	return;
+}
+
+void cpu_UpdatePageTable(Cpu *pCpu){
+	// ROM is read only, writes go to cpu_WriteControl
+	cpu_MapPages(pCpu, MAP_ROM_BANK_0, MEM_ROM_BANK_0_OFFSET, ROM_BANK_SIZE, 0);
+	if (!pCpu->sfr->BIOS) // BIOS enabled, overlays ROM bank 0
+		cpu_MapPages(pCpu, MAP_ROM_BIOS, MEM_ROM_BIOS_OFFSET, MEM_ROM_BIOS_SIZE, 0);
+	cpu_UpdateRomBankPages(pCpu);
+	cpu_MapPages(pCpu, MAP_VRAM, MEM_VIDEO_RAM_OFFSET, MEM_VIDEO_RAM_SIZE, 1);
+	cpu_UpdateRamBankPages(pCpu);
+	cpu_MapPages(pCpu, MAP_RAM_INTERNAL, MEM_RAM_INTERNAL_OFFSET, MEM_RAM_INTERNAL_SIZE, 1);
+	cpu_MapPages(pCpu, MAP_RAM_INTERNAL_ECHO, MEM_RAM_INTERNAL_ECHO_OFFSET, MEM_RAM_INTERNAL_ECHO_SIZE, 1);
+	// OAM page also holds the unusable $FEA0 - $FEFF area, it is backed by internal RAM
+	cpu_MapPages(pCpu, MAP_OAM, MEM_SPRITE_ATTRI_OFFSET, MEM_PAGE_SIZE, 1);
+	// IO ports, HRAM and IE share the last page, writes go to cpu_WriteControl
+	cpu_MapPages(pCpu, MAP_IO_PORTS, MEM_IO_PORTS_OFFSET, MEM_IO_PORTS_SIZE, 0);
+	cpu_ProtectPages(pCpu);
+	if (pCpu->blocks)
+		pCpu->blocks->stale = 1;
+	return;
+}
+
+void cpu_UpdateRomBankPages(Cpu *pCpu){
+	cpu_MapPages(pCpu, MAP_ROM_BANK_SWITCH, MEM_ROM_SWITCH_BANK_OFFSET, ROM_BANK_SIZE, 0);
+	if (pCpu->blocks)
+		pCpu->blocks->stale = 1;
+	return;
+}
+
+void cpu_UpdateRamBankPages(Cpu *pCpu){
+	uint16_t page;
+
+	if (mbc_RamMapped(pCpu))
+		cpu_MapPages(pCpu, MAP_RAM_BANK_SWITCH, MEM_RAM_SWITCH_OFFSET, RAM_BANK_SIZE, 1);
+	else{
+		// Disabled or missing RAM, MBC3 clock registers, writes go to cpu_WriteControl
+		mbc_FillPage(pCpu);
+		for (page = MEM_RAM_SWITCH_OFFSET / MEM_PAGE_SIZE; page < (MEM_RAM_SWITCH_OFFSET + RAM_BANK_SIZE) / MEM_PAGE_SIZE; page++){
+			pCpu->read_page[page] = pCpu->mbc_page;
+			pCpu->write_page[page] = NULL;
 		}
-		if (pCpu->address_bus >= MEM_HRAM_OFFSET && pCpu->address_bus < MEM_HRAM_OFFSET + MEM_HRAM_SIZE){ // HRAM
-			map = &pCpu->map[MAP_HRAM];
-		}else if (pCpu->address_bus <= MEM_IE_REG_OFFSET){
-			map = &pCpu->map[MAP_IO_PORTS];
-		}else{
-			DEBUG_PRINTF("Illegal address> $%04X\n", pCpu->address_bus);
-			return NULL;
+	}
+	cpu_ProtectPages(pCpu);
+	if (pCpu->blocks)
+		pCpu->blocks->stale = 1;
+	return;
+}
+
+void cpu_FlushBlocks(Cpu *pCpu){
+	if (!pCpu->blocks)
+		return;
+	block_Flush(pCpu->blocks);
+	cpu_UpdatePageTable(pCpu);
+	return;
+}
+
+// Write to a page without direct write access: ROM (cartridge mapper), unmapped cartridge RAM, IO ports
+// and RAM pages trapped for the block cache or the snapshot pool
+static void cpu_WriteControl(Cpu *pCpu, uint8_t data){
+	uint16_t page = pCpu->address_bus / MEM_PAGE_SIZE;
+	Block_CodePage *code;
+	uint8_t *byte, old;
+
+	// First write to a RAM page since the last snapshot
+	if (pCpu->snap && snap_Write(pCpu->snap, pCpu->read_page[page]))
+		cpu_UnprotectPage(pCpu, pCpu->read_page[page]);
+
+	// Page holds decoded blocks, drop them if the byte written is code
+	if (pCpu->blocks && (code = block_FindCodePage(pCpu->blocks, pCpu->read_page[page])) != NULL && code->active){
+		if (block_Write(pCpu->blocks, code, pCpu->address_bus % MEM_PAGE_SIZE))
+			cpu_UnprotectPage(pCpu, code->page);
+		if (page < MEM_IO_PORTS_OFFSET / MEM_PAGE_SIZE && pCpu->read_page[page] != pCpu->mbc_page){ // RAM
+			pCpu->read_page[page][pCpu->address_bus % MEM_PAGE_SIZE] = data;
+			return;
 		}
 	}
 
-	if (map != NULL){
-		byte = &map->mem.data[(pCpu->address_bus - map->offset) + map->mem.start_idx];
-		pCpu->data_bus = (*byte);
-		return byte;
-	}else{
-		DEBUG_PRINTF("map pointer is null for some reason\n");
-		return NULL;
+	if (pCpu->address_bus < MEM_VIDEO_RAM_OFFSET){ // ROM is read only
+		mbc_Write(pCpu, data);
+		return;
+	}
+	if (pCpu->read_page[page] == pCpu->mbc_page){
+		mbc_WriteRam(pCpu, data);
+		return;
+	}
+
+	// IO ports, registers with side effects
+	byte = &pCpu->read_page[page][pCpu->address_bus % MEM_PAGE_SIZE];
+	old = *byte;
+	switch (pCpu->address_bus){
+		case MEM_LY_REG_OFFSET: // read only
+			return;
+		case MEM_STAT_REG_OFFSET: // mode and coincidence flags are read only
+			*byte = (data & 0xF8) | (old & 0x07);
+			return;
+		case MEM_DIV_REG_OFFSET:
+		case MEM_TIMA_REG_OFFSET:
+		case MEM_TMA_REG_OFFSET:
+		case MEM_TAC_REG_OFFSET:
+			timer_Write(pCpu, data);
+			return;
+		case MEM_P1_REG_OFFSET:
+			joypad_Write(pCpu, data);
+			return;
+		default:
+			*byte = data;
+			break;
 	}
+	switch (pCpu->address_bus){
+		case MEM_SC_REG_OFFSET:
+			serial_Control(pCpu);
+			break;
+		case MEM_LCDC_REG_OFFSET:
+			if ((old ^ data) & 0x80){
+				if (pCpu->sfr->ctrl_operation)
+					lcd_Start(pCpu);
+				else
+					lcd_Stop(pCpu);
+			}
+			break;
+		case MEM_IF_REG_OFFSET:
+		case MEM_IE_REG_OFFSET:
+			cpu_UpdateInterrupt(pCpu);
+			break;
+		case MEM_BIOS_REG_OFFSET:
+			if (old != data)
+				cpu_UpdatePageTable(pCpu);
+			break;
+	}
+	return;
+}
+
+uint8_t* cpu_GetByte(Cpu *pCpu){ // read byte at address_bus into data_bus, return pointer to byte in memory
+	uint8_t (*byte) = &pCpu->read_page[pCpu->address_bus / MEM_PAGE_SIZE][pCpu->address_bus % MEM_PAGE_SIZE];
+	if ((pCpu->address_bus & 0xFFFE) == MEM_DIV_REG_OFFSET) // DIV and TIMA are derived when read
+		timer_Read(pCpu);
+	pCpu->data_bus = (*byte);
+	return byte;
+}
+
+void cpu_SetByte(Cpu *pCpu, uint8_t data){ // write data to byte at address_bus
+	uint8_t *page = pCpu->write_page[pCpu->address_bus / MEM_PAGE_SIZE];
+	if (page != NULL)
+		page[pCpu->address_bus % MEM_PAGE_SIZE] = data;
+	else
+		cpu_WriteControl(pCpu, data);
 }
 
 uint16_t cpu_GetWordFromPC(Cpu *pCpu){
@@ -128,1373 +294,1580 @@ uint16_t cpu_Pop(Cpu *pCpu){
 }
 
 void cpu_Push(Cpu *pCpu, uint16_t var){
-    uint8_t (*byte);
 	pCpu->address_bus = pCpu->SP - 1;
-	byte = cpu_GetByte(pCpu);
-	(*byte) = var >> 8 & 0xFF;
+	cpu_SetByte(pCpu, var >> 8 & 0xFF);
 	pCpu->address_bus = pCpu->SP - 2;
-	byte = cpu_GetByte(pCpu);
-	(*byte) = var & 0xFF;
+	cpu_SetByte(pCpu, var & 0xFF);
 	pCpu->SP -= 2;
 }
 
-void cpu_Run(Cpu *pCpu){
-	uint8_t opcode;
-	uint8_t (*byte) = NULL;
-	uint8_t bit, r1, r2, mask, dummy;
+
+/*
+	Opcode handlers
+
+	Every handler executes one instruction family, the opcode is passed to
+	decode the registers used and the operand holds the immediate byte or
+	word following the opcode (already fetched by cpu_Run).
+	Return CPU_OP_NEXT to advance PC by the opcode size or CPU_OP_JUMP when PC
+	was written by the handler.
+*/
+
+/*
+	ALU instructions
+
+	8 bit arithmetic and INC/DEC compute the result and store their
+	operands instead of writing F. Conditions read Z and C straight from
+	the operands, F is only materialised from the alu.h tables when read
+	as a whole or in part: PUSH AF, DAA, rotates, shifts, BIT, CPL, SCF,
+	CCF, 16 bit adds, and outside of the Cpu after cpu_Run/cpu_RunCycles.
+	Logic operations take their flags from a small table.
+*/
+
+// Returns carry flag
+static inline uint8_t cpu_Carry(const Cpu *pCpu){
+	switch (pCpu->flag_op){
+		case CPU_FLAGS_ADD: return (pCpu->flag_a + pCpu->flag_b + pCpu->flag_c) > 0xFF;
+		case CPU_FLAGS_SUB: return pCpu->flag_a < pCpu->flag_b + pCpu->flag_c;
+		case CPU_FLAGS_INC: case CPU_FLAGS_DEC: return pCpu->flag_c;
+		default: return pCpu->FLAG_bits.C;
+	}
+}
+
+// Returns zero flag
+static inline uint8_t cpu_Zero(const Cpu *pCpu){
+	if (pCpu->flag_op == CPU_FLAGS_SYNC)
+		return pCpu->FLAG_bits.Z;
+	return pCpu->flag_res == 0;
+}
+
+// Compute F from the last ALU operation
+static inline void cpu_SyncF(Cpu *pCpu){
+	switch (pCpu->flag_op){
+		case CPU_FLAGS_SYNC: return;
+		case CPU_FLAGS_ADD: pCpu->F = alu_add[pCpu->flag_c][pCpu->flag_a][pCpu->flag_b]; break;
+		case CPU_FLAGS_SUB: pCpu->F = alu_sub[pCpu->flag_c][pCpu->flag_a][pCpu->flag_b]; break;
+		case CPU_FLAGS_INC: pCpu->F = (pCpu->flag_c ? ALU_FLAG_C : 0) | alu_inc[pCpu->flag_a]; break;
+		case CPU_FLAGS_DEC: pCpu->F = (pCpu->flag_c ? ALU_FLAG_C : 0) | alu_dec[pCpu->flag_a]; break;
+	}
+	pCpu->flag_op = CPU_FLAGS_SYNC;
+}
+
+static inline void cpu_SetFlags(Cpu *pCpu, uint8_t op, uint8_t a, uint8_t b, uint8_t c, uint8_t res){
+	pCpu->flag_op = op;
+	pCpu->flag_a = a;
+	pCpu->flag_b = b;
+	pCpu->flag_c = c;
+	pCpu->flag_res = res;
+}
+
+// 8 bit ALU operations on A
+static inline void cpu_Add(Cpu *pCpu, uint8_t value){
+	cpu_SetFlags(pCpu, CPU_FLAGS_ADD, pCpu->A, value, 0, pCpu->A + value);
+	pCpu->A = pCpu->flag_res;
+}
+
+static inline void cpu_Adc(Cpu *pCpu, uint8_t value){
+	uint8_t carry = cpu_Carry(pCpu);
+	cpu_SetFlags(pCpu, CPU_FLAGS_ADD, pCpu->A, value, carry, pCpu->A + value + carry);
+	pCpu->A = pCpu->flag_res;
+}
+
+static inline void cpu_Sub(Cpu *pCpu, uint8_t value){
+	cpu_SetFlags(pCpu, CPU_FLAGS_SUB, pCpu->A, value, 0, pCpu->A - value);
+	pCpu->A = pCpu->flag_res;
+}
+
+static inline void cpu_Sbc(Cpu *pCpu, uint8_t value){
+	uint8_t carry = cpu_Carry(pCpu);
+	cpu_SetFlags(pCpu, CPU_FLAGS_SUB, pCpu->A, value, carry, pCpu->A - value - carry);
+	pCpu->A = pCpu->flag_res;
+}
+
+static inline void cpu_Cp(Cpu *pCpu, uint8_t value){
+	cpu_SetFlags(pCpu, CPU_FLAGS_SUB, pCpu->A, value, 0, pCpu->A - value);
+}
+
+static inline void cpu_And(Cpu *pCpu, uint8_t value){
+	pCpu->A &= value;
+	pCpu->F = alu_zero[pCpu->A] | ALU_FLAG_H;
+	pCpu->flag_op = CPU_FLAGS_SYNC;
+}
+
+static inline void cpu_Xor(Cpu *pCpu, uint8_t value){
+	pCpu->A ^= value;
+	pCpu->F = alu_zero[pCpu->A];
+	pCpu->flag_op = CPU_FLAGS_SYNC;
+}
+
+static inline void cpu_Or(Cpu *pCpu, uint8_t value){
+	pCpu->A |= value;
+	pCpu->F = alu_zero[pCpu->A];
+	pCpu->flag_op = CPU_FLAGS_SYNC;
+}
+
+// INC/DEC keep the carry flag of the previous operation
+static inline uint8_t cpu_Inc(Cpu *pCpu, uint8_t value){
+	cpu_SetFlags(pCpu, CPU_FLAGS_INC, value, 0, cpu_Carry(pCpu), value + 1);
+	return pCpu->flag_res;
+}
+
+static inline uint8_t cpu_Dec(Cpu *pCpu, uint8_t value){
+	cpu_SetFlags(pCpu, CPU_FLAGS_DEC, value, 0, cpu_Carry(pCpu), value - 1);
+	return pCpu->flag_res;
+}
+
+// Returns condition of conditional jump/call/return opcodes -> NZ, Z, NC, C
+static inline uint8_t cpu_Condition(Cpu *pCpu, uint8_t opcode){
+	switch ((opcode & 0x18) >> 3){
+		case 0: return !cpu_Zero(pCpu);
+		case 1: return cpu_Zero(pCpu);
+		case 2: return !cpu_Carry(pCpu);
+		default: return cpu_Carry(pCpu);
+	}
+}
+
+static uint8_t cpu_OpNop(Cpu *pCpu, uint8_t opcode, uint16_t operand){
+	return CPU_OP_NEXT;
+}
+
+/* Increase instructions */
+static uint8_t cpu_OpIncWord(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // INC BC, DE, HL, SP
+	uint8_t r1 = ((opcode & 0x30) >> 4);
+	CPU_DREG(pCpu, r1)++;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpIncHLInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // INC (HL)
+	pCpu->address_bus = pCpu->HL;
+	cpu_GetByte(pCpu);
+	cpu_SetByte(pCpu, cpu_Inc(pCpu, pCpu->data_bus));
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpIncReg(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // INC B, C, D, E, H, L, A
+	uint8_t r1 = (opcode & 0x38) >> 3;
+	CPU_REG(pCpu, r1).R = cpu_Inc(pCpu, CPU_REG(pCpu, r1).R);
+	return CPU_OP_NEXT;
+}
+
+/* Decrement instructions */
+static uint8_t cpu_OpDecReg(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // DEC B, C, D, E, H, L, A
+	uint8_t r1 = (opcode & 0x38) >> 3;
+	CPU_REG(pCpu, r1).R = cpu_Dec(pCpu, CPU_REG(pCpu, r1).R);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpDecHLInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // DEC (HL)
+	pCpu->address_bus = pCpu->HL;
+	cpu_GetByte(pCpu);
+	cpu_SetByte(pCpu, cpu_Dec(pCpu, pCpu->data_bus));
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpDecWord(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // DEC BC, DE, HL, SP
+	uint8_t r1 = ((opcode & 0xF0) >> 4);
+	CPU_DREG(pCpu, r1)--;
+	return CPU_OP_NEXT;
+}
+
+/* Add instructions */
+static uint8_t cpu_OpAddReg(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // ADD A, r
+	cpu_Add(pCpu, CPU_REG(pCpu, opcode & 0x07).R);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpAddHLInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // ADD A, (HL)
+	pCpu->address_bus = pCpu->HL;
+	cpu_GetByte(pCpu);
+	cpu_Add(pCpu, pCpu->data_bus);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpAddImm(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // ADD A, n
+	cpu_Add(pCpu, operand);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpAddSP(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // ADD SP, n
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.N = 0;
+	pCpu->FLAG_bits.C = (operand + pCpu->A) > 0xFF;
+	pCpu->FLAG_bits.H = ((operand & 0x0F) + (pCpu->A & 0x0F)) > 0x0F;
+	pCpu->SP += operand;
+	pCpu->FLAG_bits.Z = pCpu->A == 0;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpAddHL(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // ADD HL, BC, DE, HL, SP
+	uint8_t r1 = ((opcode & 0x30) >> 4);
 	uint16_t word;
-	uint8_t jump = 0;
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.N = 0;
+	word = (pCpu->HL & 0xFFF) + (CPU_DREG(pCpu, r1) & 0xFFF);
+	pCpu->FLAG_bits.H = word > 0xFFF;
+	pCpu->FLAG_bits.C = (pCpu->HL + CPU_DREG(pCpu, r1)) > 0xFFFF;
+	pCpu->HL += CPU_DREG(pCpu, r1);
+	return CPU_OP_NEXT;
+}
 
-	// TODO: Check for interrupt
-	if (pCpu->halt || pCpu->stop)
-		return;
+/* Add with carry instructions */
+static uint8_t cpu_OpAdcReg(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // ADC A, r
+	cpu_Adc(pCpu, CPU_REG(pCpu, opcode & 0x07).R);
+	return CPU_OP_NEXT;
+}
 
-	// Read opcode first
-	pCpu->address_bus = pCpu->PC;
-	byte = cpu_GetByte(pCpu);
-	if (byte == NULL){
-		DEBUG_PRINTF("GetByte returned error\n");
-		return;
-	}else{
-        if (pCpu->data_bus == OPCODE_EXTENDED){
-            pCpu->extended = 1;
-			pCpu->address_bus = pCpu->PC + 1;
-			byte = cpu_GetByte(pCpu);
-			if (byte == NULL){
-				DEBUG_PRINTF("GetByte returned error\n");
-				return;
-			}
-		}
-		opcode = pCpu->data_bus;
+static uint8_t cpu_OpAdcHLInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // ADC A, (HL)
+	pCpu->address_bus = pCpu->HL;
+	cpu_GetByte(pCpu);
+	cpu_Adc(pCpu, pCpu->data_bus);
+	return CPU_OP_NEXT;
+}
+
+/* Sub instructions */
+static uint8_t cpu_OpSubReg(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // SUB r
+	cpu_Sub(pCpu, CPU_REG(pCpu, opcode & 0x07).R);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpSubHLInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // SUB (HL)
+	pCpu->address_bus = pCpu->HL;
+	cpu_GetByte(pCpu);
+	cpu_Sub(pCpu, pCpu->data_bus);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpSubImm(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // SUB n
+	cpu_Sub(pCpu, operand);
+	return CPU_OP_NEXT;
+}
+
+/* Sub with carry instructions */
+static uint8_t cpu_OpSbcReg(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // SBC A, r
+	cpu_Sbc(pCpu, CPU_REG(pCpu, opcode & 0x07).R);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpSbcHLInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // SBC A, (HL)
+	pCpu->address_bus = pCpu->HL;
+	cpu_GetByte(pCpu);
+	cpu_Sbc(pCpu, pCpu->data_bus);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpSbcImm(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // SBC A, n
+	cpu_Sbc(pCpu, operand);
+	return CPU_OP_NEXT;
+}
+
+/* Load instructions */
+static uint8_t cpu_OpLdRegImm(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD r, n
+	uint8_t r1 = (opcode & 0x38) >> 3;
+	CPU_REG(pCpu, r1).R = operand;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdHLIndImm(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD (HL), n
+	pCpu->address_bus = pCpu->HL;
+	cpu_SetByte(pCpu, operand);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdWordImm(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD BC, DE, HL, SP, nn
+	uint8_t r1 = (opcode & 0x30) >> 4;
+	CPU_DREG(pCpu, r1) = operand;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdWordIndA(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD (BC), A & LD (DE), A
+	uint8_t r1 = (opcode & 0x10) >> 4;
+	pCpu->address_bus = CPU_DREG(pCpu, r1);
+	cpu_SetByte(pCpu, pCpu->A);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdHLIndA(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD (HL), A
+	pCpu->address_bus = pCpu->HL;
+	cpu_SetByte(pCpu, pCpu->A);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdImmIndA(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD (nn), A
+	pCpu->address_bus = operand;
+	cpu_SetByte(pCpu, pCpu->A);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdImmIndSP(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD (nn), SP
+	pCpu->address_bus = operand;
+	cpu_SetByte(pCpu, pCpu->SP);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdAWordInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD A, (BC) & LD A, (DE)
+	uint8_t r1 = (opcode & 0x10) >> 4;
+	pCpu->address_bus = CPU_DREG(pCpu, r1);
+	cpu_GetByte(pCpu);
+	pCpu->A = pCpu->data_bus;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdAImmInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD A, (nn)
+	pCpu->address_bus = operand;
+	cpu_GetByte(pCpu);
+	pCpu->A = pCpu->data_bus;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdRegReg(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD r, r'
+	uint8_t r1 = (opcode & 0x38) >> 3;
+	uint8_t r2 = opcode & 0x07;
+	CPU_REG(pCpu, r1).R = CPU_REG(pCpu, r2).R;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdHLIndReg(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD (HL), r
+	uint8_t r1 = opcode & 0x07;
+	pCpu->address_bus = pCpu->HL;
+	cpu_SetByte(pCpu, CPU_REG(pCpu, r1).R);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdRegHLInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD r, (HL)
+	pCpu->address_bus = pCpu->HL;
+	cpu_GetByte(pCpu);
+	pCpu->A = pCpu->data_bus;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdHLIncDecA(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD (HL+), A & LD (HL-), A
+	pCpu->address_bus = pCpu->HL;
+	cpu_SetByte(pCpu, pCpu->A);
+	pCpu->HL += (opcode & 0xF0) == 0x20 ? 1 : -1;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdAHLIncDec(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD A, (HL+) & LD A, (HL-)
+	pCpu->address_bus = pCpu->HL;
+	cpu_GetByte(pCpu);
+	pCpu->A = pCpu->data_bus;
+	pCpu->HL += (opcode & 0xF0) == 0x20 ? 1 : -1;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdhImmA(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LDH ($FF00 + n), A
+	pCpu->address_bus = 0xFF00 + operand;
+	cpu_SetByte(pCpu, pCpu->A);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdCIndA(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD (C), A
+	pCpu->address_bus = 0xFF00 + pCpu->C;
+	cpu_SetByte(pCpu, pCpu->A);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdhAImm(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LDH A, ($FF00 + n)
+	pCpu->address_bus = 0xFF00 + operand;
+	cpu_GetByte(pCpu);
+	pCpu->A = pCpu->data_bus;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdACInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD A, (C)
+	pCpu->address_bus = 0xFF00 + pCpu->C;
+	cpu_GetByte(pCpu);
+	pCpu->A = pCpu->data_bus;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdHLSPImm(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD HL, SP + n
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.Z = 0;
+	pCpu->FLAG_bits.N = 0;
+	pCpu->FLAG_bits.C = (pCpu->SP + operand) > 0xFFFF;
+	pCpu->FLAG_bits.H = ((pCpu->SP & 0xFFF) + operand) > 0x0FFF;
+	pCpu->HL = pCpu->SP + operand;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpLdSPHL(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // LD SP, HL
+	pCpu->SP = pCpu->HL;
+	return CPU_OP_NEXT;
+}
+
+/* And instructions */
+static uint8_t cpu_OpAndReg(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // AND r
+	cpu_And(pCpu, CPU_REG(pCpu, opcode & 0x07).R);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpAndHLInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // AND (HL)
+	pCpu->address_bus = pCpu->HL;
+	cpu_GetByte(pCpu);
+	cpu_And(pCpu, pCpu->data_bus);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpAndImm(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // AND n
+	cpu_And(pCpu, operand);
+	return CPU_OP_NEXT;
+}
+
+/* Xor instructions */
+static uint8_t cpu_OpXorReg(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // XOR r
+	cpu_Xor(pCpu, CPU_REG(pCpu, opcode & 0x07).R);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpXorHLInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // XOR (HL)
+	pCpu->address_bus = pCpu->HL;
+	cpu_GetByte(pCpu);
+	cpu_Xor(pCpu, pCpu->data_bus);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpXorImm(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // XOR n
+	cpu_Xor(pCpu, operand);
+	return CPU_OP_NEXT;
+}
+
+/* Or instructions */
+static uint8_t cpu_OpOrReg(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // OR r
+	cpu_Or(pCpu, CPU_REG(pCpu, opcode & 0x07).R);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpOrHLInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // OR (HL)
+	pCpu->address_bus = pCpu->HL;
+	cpu_GetByte(pCpu);
+	cpu_Or(pCpu, pCpu->data_bus);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpOrImm(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // OR n
+	cpu_Or(pCpu, operand);
+	return CPU_OP_NEXT;
+}
+
+/* Compare instructions */
+static uint8_t cpu_OpCpReg(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // CP r
+	cpu_Cp(pCpu, CPU_REG(pCpu, opcode & 0x07).R);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpCpHLInd(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // CP (HL)
+	pCpu->address_bus = pCpu->HL;
+	cpu_GetByte(pCpu);
+	cpu_Cp(pCpu, pCpu->data_bus);
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpCpImm(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // CP n
+	cpu_Cp(pCpu, operand);
+	return CPU_OP_NEXT;
+}
+
+/* Rotate Instructions */
+static uint8_t cpu_OpRrca(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // RRCA - 9 bit rotate right
+	uint8_t dummy;
+	cpu_SyncF(pCpu);
+	dummy = pCpu->FLAG_bits.C;
+	pCpu->FLAG_bits.C = pCpu->A & 0x01;
+	pCpu->FLAG_bits.H = 0;
+	pCpu->FLAG_bits.N = 0;
+	pCpu->A = (pCpu->A >> 1 & 0x7F) | dummy << 7;
+	pCpu->FLAG_bits.Z = pCpu->A == 0;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpRra(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // RRA
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.C = pCpu->A & 0x01;
+	pCpu->FLAG_bits.H = 0;
+	pCpu->FLAG_bits.N = 0;
+	pCpu->A = (pCpu->A >> 1 & 0x7F) | pCpu->FLAG_bits.C << 7;
+	pCpu->FLAG_bits.Z = pCpu->A == 0;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpRlca(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // RLCA - 9 bit rotate left
+	uint8_t dummy;
+	cpu_SyncF(pCpu);
+	dummy = pCpu->FLAG_bits.C;
+	pCpu->FLAG_bits.C = (pCpu->A >> 7) & 1;
+	pCpu->FLAG_bits.H = 0;
+	pCpu->FLAG_bits.N = 0;
+	pCpu->A = (pCpu->A << 1 & 0xFE) | dummy;
+	pCpu->FLAG_bits.Z = pCpu->A == 0;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpRla(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // RLA - 8 bit rotate left
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.C = (pCpu->A >> 7) & 1;
+	pCpu->FLAG_bits.H = 0;
+	pCpu->FLAG_bits.N = 0;
+	pCpu->A = (pCpu->A << 1 & 0xFE) | pCpu->FLAG_bits.C;
+	pCpu->FLAG_bits.Z = pCpu->A == 0;
+	return CPU_OP_NEXT;
+}
+
+/* Stop & Halt instructions */
+static uint8_t cpu_OpStop(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // STOP
+	pCpu->stop = 1;
+	return CPU_OP_NEXT;
+}
+
+static uint8_t cpu_OpHalt(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // HALT
+	pCpu->halt = 1;
+	return CPU_OP_NEXT;
+}
+
+/* Jump relatif instructions */
+static uint8_t cpu_OpJr(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // JR n
+	pCpu->PC += 2;
+	pCpu->PC += (int8_t)operand;
+	return CPU_OP_JUMP;
+}
+
+static uint8_t cpu_OpJrCond(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // JR NZ, Z, NC, C
+	uint8_t jump = CPU_OP_NEXT;
+	if (cpu_Condition(pCpu, opcode)){
+		pCpu->PC += 2;
+		pCpu->PC += (int8_t)operand;
+		jump = CPU_OP_JUMP;
 	}
+	return jump;
+}
 
-	if (!pCpu->extended){ // page0 opcodes
-		DEBUG_PRINTF("$%04X> %02X\t", pCpu->PC, opcode);
-		switch (opcode){
-			case 0x00:// NOP
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+/* Jump absolute instructions */
+static uint8_t cpu_OpJp(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // JP nnnn
+	pCpu->PC = operand;
+	return CPU_OP_JUMP;
+}
 
-			/* Increase instructions */
-			case 0x03: // INC BC
-			case 0x13: // INC DE
-			case 0x23: // INC HL
-			case 0x33: // INC SP
-				r1 = ((opcode & 0x30) >> 4);
-				(*pCpu->dreg[r1])++;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+static uint8_t cpu_OpJpCond(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // JP NZ, Z, NC, C, nnnn
+	uint8_t jump = CPU_OP_NEXT;
+	if (cpu_Condition(pCpu, opcode)){
+		pCpu->PC = operand;
+		jump = CPU_OP_JUMP;
+	}
+	return jump;
+}
 
-			case 0x34: // INC (HL)
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 0;
-				dummy = (pCpu->data_bus & 0x0F) + 1;
-				(*byte) = pCpu->data_bus++;
-				pCpu->FLAG_bits.H = dummy > 0xF;
-				pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+static uint8_t cpu_OpJpHL(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // JP (HL)
+	pCpu->PC = pCpu->HL;
+	return CPU_OP_JUMP;
+}
 
-			case 0x04: // INC B
-			case 0x0C: // INC C
-			case 0x14: // INC D
-			case 0x1C: // INC E
-			case 0x24: // INC H
-			case 0x2C: // INC L
-			case 0x3C: // INC A
-				pCpu->FLAG_bits.N = 0;
-				r1 = (opcode & 0x38) >> 3;
-				dummy = (pCpu->reg[r1]->R & 0x0F) + 1;
-				pCpu->reg[r1]->R++;
-				pCpu->FLAG_bits.H = dummy > 0xF;
-				pCpu->FLAG_bits.Z = pCpu->reg[r1]->R == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+/* Call instructions */
+static uint8_t cpu_OpCall(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // CALL nnnn
+	cpu_Push(pCpu, pCpu->PC + page0[opcode].size);
+	pCpu->PC = operand;
+	if (pCpu->callprof)
+		callprof_Call(pCpu, operand);
+	return CPU_OP_JUMP;
+}
 
-			/* Decrement instructions */
-			case 0x05: // DEC B
-			case 0x0D: // DEC C
-			case 0x15: // DEC D
-			case 0x1D: // DEC E
-			case 0x25: // DEC H
-			case 0x2D: // DEC L
-			case 0x3D: // DEC A
-				pCpu->FLAG_bits.N = 1;
-				r1 = (opcode & 0x38) >> 3;
-				dummy = pCpu->reg[r1]->R & 0x10;
-				pCpu->reg[r1]->R--;
-				pCpu->FLAG_bits.H = dummy == 0x10;
-				pCpu->FLAG_bits.Z = pCpu->reg[r1]->R == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0x35: // DEC (HL)
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 1;
-				dummy = pCpu->data_bus & 0x10;
-				(*byte) = pCpu->data_bus--;
-				pCpu->FLAG_bits.H = dummy == 0x10;
-				pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+static uint8_t cpu_OpCallCond(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // CALL NZ, Z, NC, C, nnnn
+	uint8_t jump = CPU_OP_NEXT;
+	if (cpu_Condition(pCpu, opcode)){
+		cpu_Push(pCpu, pCpu->PC + page0[opcode].size);
+		pCpu->PC = operand;
+		if (pCpu->callprof)
+			callprof_Call(pCpu, operand);
+		jump = CPU_OP_JUMP;
+	}
+	return jump;
+}
 
-			case 0x0B: // DEC BC
-			case 0x1B: // DEC DE
-			case 0x2B: // DEC HL
-			case 0x3B: // DEC SP
-				r1 = ((opcode & 0xF0) >> 4);
-				(*pCpu->dreg[r1])--;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[pCpu->data_bus].mnemonic, page0[pCpu->data_bus].description);
-				break;
+/* Return instructions */
+static uint8_t cpu_OpRetCond(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // RET NZ, Z, NC, C
+	uint8_t jump = CPU_OP_NEXT;
+	if (cpu_Condition(pCpu, opcode)){
+		if (pCpu->callprof)
+			callprof_Return(pCpu);
+		pCpu->PC = cpu_Pop(pCpu);
+		jump = CPU_OP_JUMP;
+	}
+	return jump;
+}
 
-			/* Add instructions */
-			case 0x80: // ADD A, B
-			case 0x81: // ADD A, C
-			case 0x82: // ADD A, D
-			case 0x83: // ADD A, E
-			case 0x84: // ADD A, H
-			case 0x85: // ADD A, L
-			case 0x87: // ADD A, A
-				r1 = opcode & 0x07;
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = (pCpu->reg[r1]->R + pCpu->A) > 0xFF;
-				pCpu->FLAG_bits.H = ((pCpu->reg[r1]->R & 0x0F) + (pCpu->A & 0x0F)) > 0x0F;
-				pCpu->A += pCpu->reg[r1]->R;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0x86: // ADD A, (HL)
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = (pCpu->data_bus + pCpu->A) > 0xFF;
-				pCpu->FLAG_bits.H = ((pCpu->data_bus & 0x0F) + (pCpu->A & 0x0F)) > 0x0F;
-				pCpu->A += pCpu->data_bus;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xC6: // ADD A, n
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = (pCpu->data_bus + pCpu->A) > 0xFF;
-				pCpu->FLAG_bits.H = ((pCpu->data_bus & 0x0F) + (pCpu->A & 0x0F)) > 0x0F;
-				pCpu->A += pCpu->data_bus;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
+static uint8_t cpu_OpRet(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // RET
+	if (pCpu->callprof)
+		callprof_Return(pCpu);
+	pCpu->PC = cpu_Pop(pCpu);
+	return CPU_OP_JUMP;
+}
 
-			case 0xE8: // ADD SP, n
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = (pCpu->data_bus + pCpu->A) > 0xFF;
-				pCpu->FLAG_bits.H = ((pCpu->data_bus & 0x0F) + (pCpu->A & 0x0F)) > 0x0F;
-				pCpu->SP += pCpu->data_bus;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
+static uint8_t cpu_OpReti(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // RETI
+	if (pCpu->callprof)
+		callprof_Return(pCpu);
+	pCpu->PC = cpu_Pop(pCpu);
+	// Interrupts enabled again right away, unlike EI
+	pCpu->ime = 1;
+	cpu_UpdateInterrupt(pCpu);
+	return CPU_OP_JUMP;
+}
 
-			case 0x09: // ADD HL, BC
-			case 0x19: // ADD HL, DE
-			case 0x29: // ADD HL, HL
-			case 0x39: // ADD HL, SP
-				r1 = ((opcode & 0x30) >> 4);
-				pCpu->FLAG_bits.N = 0;
-				word = (pCpu->HL & 0xFFF) + ((*pCpu->dreg[r1]) & 0xFFF);
-				pCpu->FLAG_bits.H = word > 0xFFF;
-				pCpu->FLAG_bits.C = (pCpu->HL + (*pCpu->dreg[r1])) > 0xFFFF;
-				pCpu->HL += (*pCpu->dreg[r1]);
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+/* Reset instructions */
+static uint8_t cpu_OpRst(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // RST $0000 - $0038
+	cpu_Push(pCpu, pCpu->PC);
+	pCpu->PC = (((opcode & 0xF0) >> 4) - 0xC) * 0x10 + ((opcode & 0x0F) == 0x0F ? 0x08 : 0x00);
+	if (pCpu->callprof)
+		callprof_Call(pCpu, pCpu->PC);
+	return CPU_OP_JUMP;
+}
 
-			/* Add with carry instructions */
-			case 0x88: // ADC A, B
-			case 0x89: // ADC A, C
-			case 0x8A: // ADC A, D
-			case 0x8B: // ADC A, E
-			case 0x8C: // ADC A, H
-			case 0x8D: // ADC A, L
-			case 0x8F: // ADC A, A
-				r1 = opcode & 0x07;
-				pCpu->FLAG_bits.N = 0;
-				dummy = pCpu->FLAG_bits.C;
-				pCpu->FLAG_bits.C = (pCpu->reg[r1]->R + pCpu->A + dummy) > 0xFF;
-				pCpu->FLAG_bits.H = ((pCpu->reg[r1]->R & 0x0F) + ((pCpu->A & 0x0F) + dummy)) > 0x0F;
-				pCpu->A += pCpu->reg[r1]->R + dummy;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0x8E: // ADC A, (HL)
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 0;
-				dummy = pCpu->FLAG_bits.C;
-				pCpu->FLAG_bits.C = (pCpu->data_bus + pCpu->A + dummy) > 0xFF;
-				pCpu->FLAG_bits.H = ((pCpu->data_bus & 0x0F) + ((pCpu->A & 0x0F) + dummy)) > 0x0F;
-				pCpu->A += pCpu->data_bus + dummy;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+/* Pop instructions */
+static uint8_t cpu_OpPop(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // POP BC, DE, HL
+	uint8_t r1 = (opcode & 0x30) >> 4;
+	CPU_DREG(pCpu, r1) = cpu_Pop(pCpu);
+	return CPU_OP_NEXT;
+}
 
-			/* Sub instructions */
-			case 0x90: // SUB B
-			case 0x91: // SUB C
-			case 0x92: // SUB D
-			case 0x93: // SUB E
-			case 0x94: // SUB H
-			case 0x95: // SUB L
-			case 0x97: // SUB A
-				r1 = opcode & 0x07;
-				pCpu->FLAG_bits.N = 1;
-				pCpu->FLAG_bits.C = (pCpu->A & 0xF0) < (pCpu->reg[r1]->R & 0xF0);
-				pCpu->FLAG_bits.H = (pCpu->A & 0x0F) < (pCpu->reg[r1]->R & 0x0F);
-				pCpu->A -= pCpu->reg[r1]->R;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0x96: // SUB (HL)
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 1;
-				pCpu->FLAG_bits.C = (pCpu->A & 0xF0) < (pCpu->data_bus & 0xF0);
-				pCpu->FLAG_bits.H = (pCpu->A & 0x0F) < (pCpu->data_bus & 0x0F);
-				pCpu->A -= pCpu->data_bus;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xD6: // SUB n
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 1;
-				pCpu->FLAG_bits.C = (pCpu->A & 0xF0) < (pCpu->data_bus & 0xF0);
-				pCpu->FLAG_bits.H = (pCpu->A & 0x0F) < (pCpu->data_bus & 0x0F);
-				pCpu->A -= pCpu->data_bus;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
+static uint8_t cpu_OpPopAF(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // POP AF
+	pCpu->AF = cpu_Pop(pCpu);
+	pCpu->flag_op = CPU_FLAGS_SYNC;
+	return CPU_OP_NEXT;
+}
 
-			/* Sub with carry instructions */
-			case 0x98: // SBC B
-			case 0x99: // SBC C
-			case 0x9A: // SBC D
-			case 0x9B: // SBC E
-			case 0x9C: // SBC H
-			case 0x9D: // SBC L
-			case 0x9F: // SBC A
-				r1 = opcode & 0x07;
-				pCpu->FLAG_bits.N = 1;
-				dummy = pCpu->FLAG_bits.C;
-				pCpu->FLAG_bits.C = (pCpu->A & 0xF0) < (pCpu->reg[r1]->R & 0xF0);
-				pCpu->FLAG_bits.H = (pCpu->A & 0x0F) < (pCpu->reg[r1]->R & 0x0F);
-				pCpu->A -= (pCpu->reg[r1]->R + dummy);
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0x9E: // SBC (HL)
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 1;
-				dummy = pCpu->FLAG_bits.C;
-				pCpu->FLAG_bits.C = (pCpu->A & 0xF0) < (pCpu->data_bus & 0xF0);
-				pCpu->FLAG_bits.H = (pCpu->A & 0x0F) < (pCpu->data_bus & 0x0F);
-				pCpu->A -= (pCpu->data_bus + dummy);
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xDE: // SBC A, n
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 1;
-				dummy = pCpu->FLAG_bits.C;
-				pCpu->FLAG_bits.C = (pCpu->A & 0xF0) < (pCpu->data_bus & 0xF0);
-				pCpu->FLAG_bits.H = (pCpu->A & 0x0F) < (pCpu->data_bus & 0x0F);
-				pCpu->A -= (pCpu->data_bus + dummy);
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
+/* Push instructions */
+static uint8_t cpu_OpPush(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // PUSH BC, DE, HL
+	uint8_t r1 = (opcode & 0x30) >> 4;
+	cpu_Push(pCpu, CPU_DREG(pCpu, r1));
+	return CPU_OP_NEXT;
+}
 
-			/* Load instructions */
-			case 0x06: // LD B, n
-			case 0x0E: // LD C, n
-			case 0x16: // LD D, n
-			case 0x1E: // LD E, n
-			case 0x26: // LD H, n
-			case 0x2E: // LD L, n
-			case 0x3E: // LD A, n
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				r1 = (opcode & 0x38) >> 3;
-				pCpu->reg[r1]->R = pCpu->data_bus;
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0x36: // LD (HL), n
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				pCpu->address_bus = pCpu->PC + 1;
-				cpu_GetByte(pCpu);
-				(*byte) = pCpu->data_bus;
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
+static uint8_t cpu_OpPushAF(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // PUSH AF
+	cpu_SyncF(pCpu);
+	cpu_Push(pCpu, pCpu->AF);
+	return CPU_OP_NEXT;
+}
 
-			case 0x01: // LD BC, nn
-			case 0x11: // LD DE, nn
-			case 0x21: // LD HL, nn
-			case 0x31: // LD SP, nn
-				r1 = (opcode & 0x30) >> 4;
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				*pCpu->dreg[r1] = word;
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
+/* Decimal Adjust instruction */
+static uint8_t cpu_OpDaa(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // DAA
+	cpu_SyncF(pCpu);
+	pCpu->AF = alu_daa[ALU_DAA_INDEX(pCpu->AF)];
+	return CPU_OP_NEXT;
+}
 
-			case 0x02: // LD (BC), A
-			case 0x12: // LD (DE), A
-				r1 = (opcode & 0x10) >> 4;
-				pCpu->address_bus = (*pCpu->dreg[r1]);
-				byte = cpu_GetByte(pCpu);
-				(*byte) = pCpu->A;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0x77: // LD (HL), A
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				(*byte) = pCpu->A;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xEA: // LD (nn), A
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				pCpu->address_bus = word;
-				byte = cpu_GetByte(pCpu);
-				(*byte) = pCpu->A;
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
+/* Complement instruction */
+static uint8_t cpu_OpCpl(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // CPL
+	cpu_SyncF(pCpu);
+	pCpu->A = ~pCpu->A;
+	pCpu->FLAG_bits.N = 1;
+	pCpu->FLAG_bits.H = 1;
+	return CPU_OP_NEXT;
+}
 
-			case 0x08: // LD nn, SP
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				pCpu->address_bus = word;
-				byte = cpu_GetByte(pCpu);
-				(*byte) = pCpu->SP;
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
+/* Carry set/reset instructions */
+static uint8_t cpu_OpScf(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // SCF
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.C = 1;
+	return CPU_OP_NEXT;
+}
 
-			case 0x0A: // LD A, (BC)
-			case 0x1A: // LD A, (DE)
-				r1 = (opcode & 0x10) >> 4;
-				pCpu->address_bus = (*pCpu->dreg[r1]);
-				byte = cpu_GetByte(pCpu);
-				pCpu->A = pCpu->data_bus;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+static uint8_t cpu_OpCcf(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // CCF
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.C = 0;
+	return CPU_OP_NEXT;
+}
 
-			case 0xFA: // LD A, (nn)
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				pCpu->address_bus = word;
-				byte = cpu_GetByte(pCpu);
-				pCpu->A = pCpu->data_bus;
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
+/* Disable/Enable Interrupt instruction */
+// TODO : check if this is correct
+static uint8_t cpu_OpDi(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // DI
+	pCpu->ime = 0;
+	pCpu->ime_delay = 0;
+	cpu_UpdateInterrupt(pCpu);
+	return CPU_OP_NEXT;
+}
 
-			case 0x40: // LD B, B  0100 0000
-			case 0x41: // LD B, C
-			case 0x42: // LD B, D
-			case 0x43: // LD B, E
-			case 0x44: // LD B, H
-			case 0x45: // LD B, L
-			case 0x47: // LD B, A
-			case 0x48: // LD C, B  0100 1000
-			case 0x49: // LD C, C
-			case 0x4A: // LD C, D
-			case 0x4B: // LD C, E
-			case 0x4C: // LD C, H
-			case 0x4D: // LD C, L
-			case 0x4F: // LD C, A
-			case 0x50: // LD D, B  0101 0000
-			case 0x51: // LD D, C
-			case 0x52: // LD D, D
-			case 0x53: // LD D, E
-			case 0x54: // LD D, H
-			case 0x55: // LD D, L
-			case 0x57: // LD D, A
-			case 0x58: // LD E, B  0101 1000
-			case 0x59: // LD E, C
-			case 0x5A: // LD E, D
-			case 0x5B: // LD E, E
-			case 0x5C: // LD E, H
-			case 0x5D: // LD E, L
-			case 0x5F: // LD E, A
-			case 0x60: // LD H, B  0110 0000
-			case 0x61: // LD H, C
-			case 0x62: // LD H, D
-			case 0x63: // LD H, E
-			case 0x64: // LD H, H
-			case 0x65: // LD H, L
-			case 0x67: // LD H, A
-			case 0x68: // LD L, B  0110 1000
-			case 0x69: // LD L, C
-			case 0x6A: // LD L, D
-			case 0x6B: // LD L, E
-			case 0x6C: // LD L, H
-			case 0x6D: // LD L, L
-			case 0x6F: // LD L, A
-			case 0x78: // LD A, B  0111 1000
-			case 0x79: // LD A, C
-			case 0x7A: // LD A, D
-			case 0x7B: // LD A, E
-			case 0x7C: // LD A, H
-			case 0x7D: // LD A, L
-			case 0x7F: // LD A, A
-				r1 = (opcode & 0x38) >> 3;
-				r2 = opcode & 0x07;
-				pCpu->reg[r1]->R = pCpu->reg[r2]->R;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+static uint8_t cpu_OpEi(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // EI
+	pCpu->ime_delay = 1;
+	cpu_UpdateInterrupt(pCpu);
+	return CPU_OP_NEXT;
+}
 
-			case 0x70: // LD (HL), B
-			case 0x71: // LD (HL), C
-			case 0x72: // LD (HL), D
-			case 0x73: // LD (HL), E
-			case 0x74: // LD (HL), H
-			case 0x75: // LD (HL), L
-				r1 = opcode & 0x07;
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				(*byte) = pCpu->reg[r1]->R;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+/* Illegal & unknown instructions */
+static uint8_t cpu_OpIllegal(Cpu *pCpu, uint8_t opcode, uint16_t operand){
+	DEBUG_PRINTF("\nIllegal instruction %02X\n", opcode);
+	// The LR35902 locks up, stop fetching instead of spinning on a 0 cycle opcode
+	pCpu->stop = 1;
+	return CPU_OP_NEXT;
+}
 
-			case 0x46: // LD B, (HL)
-			case 0x4E: // LD C, (HL)
-			case 0x56: // LD D, (HL)
-			case 0x5E: // LD E, (HL)
-			case 0x66: // LD H, (HL)
-			case 0x6E: // LD L, (HL)
-			case 0x7E: // LD A, (HL)
-				r1 = (opcode & 0x38) >> 3;
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				pCpu->A = pCpu->data_bus;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+static uint8_t cpu_OpUnknown(Cpu *pCpu, uint8_t opcode, uint16_t operand){
+	DEBUG_PRINTF("\nUnknown instruction 0x%02Xnot yet implemented.\n", opcode);
+	return CPU_OP_NEXT;
+}
 
-			case 0x22: // LD (HL+), A
-			case 0x32: // LD (HL-), A
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				(*byte) = pCpu->A;
-				pCpu->HL += (opcode & 0xF0) == 0x20 ? 1 : -1;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0x2A: // LD A, (HL+)
-			case 0x3A: // LD A, (HL-)
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				pCpu->A = pCpu->data_bus;
-				pCpu->HL += (opcode & 0xF0) == 0x20 ? 1 : -1;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+/*
+	Extended opcode handlers (0xCB prefix)
 
-			case 0xE0: // LDH ($FF00 + n), A
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				pCpu->address_bus = 0xFF00 + pCpu->data_bus;
-				byte = cpu_GetByte(pCpu);
-				(*byte) = pCpu->A;
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0xE2: // LD (C), A
-				pCpu->address_bus = 0xFF00 + pCpu->C;
-				byte = cpu_GetByte(pCpu);
-				(*byte) = pCpu->A;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+	Bits 0-2 of the opcode select the register, 6 being (HL).
+*/
 
-			case 0xF0: // LDH A, ($FF00 + n)
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				pCpu->address_bus = 0xFF00 + pCpu->data_bus;
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				byte = cpu_GetByte(pCpu);
-				pCpu->A = pCpu->data_bus;
-				break;
-			case 0xF2: // LD A, (C)
-				pCpu->address_bus = 0xFF00 + pCpu->C;
-				byte = cpu_GetByte(pCpu);
-				pCpu->A = pCpu->data_bus;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+static uint8_t cpu_OpRlc(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // RLC 9 bit rotate left with carry
+	uint8_t r1, dummy;
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.N = 0;
+	pCpu->FLAG_bits.H = 0;
+	dummy = pCpu->FLAG_bits.C;
 
-			case 0xF8: // LD HL, SP + n
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.Z = 0;
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = (pCpu->SP + pCpu->data_bus) > 0xFFFF;
-				pCpu->FLAG_bits.H = ((pCpu->SP & 0xFFF) + pCpu->data_bus) > 0x0FFF;
-				pCpu->HL = pCpu->SP + pCpu->data_bus;
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
+	r1 = opcode & 0x07;
+	if (r1 != 0x06){
+		pCpu->FLAG_bits.C = CPU_REG(pCpu, r1).R_bits.bit_7;
+		CPU_REG(pCpu, r1).R = dummy | ((CPU_REG(pCpu, r1).R << 1) & 0xFE);
+		pCpu->FLAG_bits.Z = CPU_REG(pCpu, r1).R == 0;
+	}else{
+		pCpu->address_bus = pCpu->HL;
+		cpu_GetByte(pCpu);
+		pCpu->FLAG_bits.C = (pCpu->data_bus >> 7) & 1;
+		cpu_SetByte(pCpu, dummy | ((pCpu->data_bus << 1) & 0xFE));
+		pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
+	}
+	return CPU_OP_NEXT;
+}
 
-			case 0xF9: // LD SP, HL
-				pCpu->SP = pCpu->HL;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+static uint8_t cpu_OpRrc(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // RRC 9 bit rotate right with carry
+	uint8_t r1, dummy;
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.N = 0;
+	pCpu->FLAG_bits.H = 0;
+	dummy = pCpu->FLAG_bits.C;
+
+	r1 = opcode & 0x07;
+	if (r1 != 0x06){
+		pCpu->FLAG_bits.C = CPU_REG(pCpu, r1).R_bits.bit_0;
+		CPU_REG(pCpu, r1).R = (dummy << 7) | ((CPU_REG(pCpu, r1).R >> 1) & 0x7F);
+		pCpu->FLAG_bits.Z = CPU_REG(pCpu, r1).R == 0;
+	}else{
+		pCpu->address_bus = pCpu->HL;
+		cpu_GetByte(pCpu);
+		pCpu->FLAG_bits.C = pCpu->data_bus & 0x01;
+		cpu_SetByte(pCpu, (dummy << 7) | ((pCpu->data_bus >> 1) & 0x7F));
+		pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
+	}
+	return CPU_OP_NEXT;
+}
 
+static uint8_t cpu_OpRl(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // RL 8 bit rotate left
+	uint8_t r1;
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.N = 0;
+	pCpu->FLAG_bits.H = 0;
+
+	r1 = opcode & 0x07;
+	if (r1 != 0x06){
+		pCpu->FLAG_bits.C = CPU_REG(pCpu, r1).R_bits.bit_7;
+		CPU_REG(pCpu, r1).R = pCpu->FLAG_bits.C | ((CPU_REG(pCpu, r1).R << 1) & 0xFE);
+		pCpu->FLAG_bits.Z = CPU_REG(pCpu, r1).R == 0;
+	}else{
+		pCpu->address_bus = pCpu->HL;
+		cpu_GetByte(pCpu);
+		pCpu->FLAG_bits.C = (pCpu->data_bus >> 7) & 1;
+		cpu_SetByte(pCpu, pCpu->FLAG_bits.C | ((pCpu->data_bus << 1) & 0xFE));
+		pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
+	}
+	return CPU_OP_NEXT;
+}
 
-			/* And instructions */
-			case 0xA0: // AND B
-			case 0xA1: // AND C
-			case 0xA2: // AND D
-			case 0xA3: // AND E
-			case 0xA4: // AND L
-			case 0xA5: // AND H
-			case 0xA7: // AND A
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = 0;
-				pCpu->FLAG_bits.H = 1;
-				r1 = opcode & 0x07;
-				pCpu->A &= pCpu->reg[r1]->R;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xA6: // AND (HL)
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = 0;
-				pCpu->FLAG_bits.H = 1;
-				pCpu->A &= pCpu->data_bus;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xE6: // AND n
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = 0;
-				pCpu->FLAG_bits.H = 1;
-				pCpu->A &= pCpu->data_bus;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
+static uint8_t cpu_OpRr(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // RR 8 bit rotate right
+	uint8_t r1;
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.N = 0;
+	pCpu->FLAG_bits.H = 0;
+
+	r1 = opcode & 0x07;
+	if (r1 != 0x06){
+		pCpu->FLAG_bits.C = CPU_REG(pCpu, r1).R_bits.bit_0;
+		CPU_REG(pCpu, r1).R = (pCpu->FLAG_bits.C << 7) | ((CPU_REG(pCpu, r1).R >> 1) & 0x7F);
+		pCpu->FLAG_bits.Z = CPU_REG(pCpu, r1).R == 0;
+	}else{
+		pCpu->address_bus = pCpu->HL;
+		cpu_GetByte(pCpu);
+		pCpu->FLAG_bits.C = pCpu->data_bus & 0x01;
+		cpu_SetByte(pCpu, (pCpu->FLAG_bits.C << 7) | ((pCpu->data_bus >> 1) & 0x7F));
+		pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
+	}
+	return CPU_OP_NEXT;
+}
 
+static uint8_t cpu_OpSla(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // SLA
+	uint8_t r1;
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.N = 0;
+	pCpu->FLAG_bits.H = 0;
+
+	r1 = opcode & 0x07;
+	if (r1 != 0x06){
+		pCpu->FLAG_bits.C = CPU_REG(pCpu, r1).R_bits.bit_7;
+		CPU_REG(pCpu, r1).R = (CPU_REG(pCpu, r1).R << 1) & 0xFE;
+		pCpu->FLAG_bits.Z = CPU_REG(pCpu, r1).R == 0;
+	}else{
+		pCpu->address_bus = pCpu->HL;
+		cpu_GetByte(pCpu);
+		pCpu->FLAG_bits.C = (pCpu->data_bus >> 7) & 1;
+		cpu_SetByte(pCpu, (pCpu->data_bus << 1) & 0xFE);
+		pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
+	}
+	return CPU_OP_NEXT;
+}
 
-			/* Xor instructions */
-			case 0xA8: // XOR B
-			case 0xA9: // XOR C
-			case 0xAA: // XOR D
-			case 0xAB: // XOR E
-			case 0xAC: // XOR H
-			case 0xAD: // XOR L
-			case 0xAF: // XOR A
-				r1 = opcode & 0x07;
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = 0;
-				pCpu->FLAG_bits.H = 0;
-				pCpu->A ^= pCpu->reg[r1]->R;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xAE: // XOR (HL)
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = 0;
-				pCpu->FLAG_bits.H = 0;
-				pCpu->A ^= pCpu->data_bus;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xEE: // XOR n
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = 0;
-				pCpu->FLAG_bits.H = 0;
-				pCpu->A ^= pCpu->data_bus;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
+static uint8_t cpu_OpSra(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // SRA
+	uint8_t r1;
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.N = 0;
+	pCpu->FLAG_bits.H = 0;
+
+	r1 = opcode & 0x07;
+	if (r1 != 0x06){
+		pCpu->FLAG_bits.C = CPU_REG(pCpu, r1).R_bits.bit_0;
+		CPU_REG(pCpu, r1).R = (0x80 & CPU_REG(pCpu, r1).R) | ((CPU_REG(pCpu, r1).R >> 1) & 0x7F);
+		pCpu->FLAG_bits.Z = CPU_REG(pCpu, r1).R == 0;
+	}else{
+		pCpu->address_bus = pCpu->HL;
+		cpu_GetByte(pCpu);
+		pCpu->FLAG_bits.C = pCpu->data_bus & 0x01;
+		cpu_SetByte(pCpu, (0x80 & pCpu->data_bus) | ((pCpu->data_bus >> 1) & 0x7F));
+		pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
+	}
+	return CPU_OP_NEXT;
+}
 
-			/* Or instructions */
-			case 0xB0: // OR B
-			case 0xB1: // OR C
-			case 0xB2: // OR D
-			case 0xB3: // OR E
-			case 0xB4: // OR H
-			case 0xB5: // OR L
-			case 0xB7: // OR A
-				r1 = opcode & 0x07;
-				pCpu->A |= pCpu->reg[r1]->R;
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = 0;
-				pCpu->FLAG_bits.H = 0;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xB6: // OR (HL)
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = 0;
-				pCpu->FLAG_bits.H = 0;
-				pCpu->A |= pCpu->data_bus;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xF6: // OR n
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.C = 0;
-				pCpu->FLAG_bits.H = 0;
-				pCpu->A |= pCpu->data_bus;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+#define SWAP(x) (x) = ((((x) & 0xF0) >> 4) | (((x) & 0x0F) << 4))
 
-			/* Compare instructions */
-			case 0xB8: // CP B
-			case 0xB9: // CP C
-			case 0xBA: // CP D
-			case 0xBB: // CP E
-			case 0xBC: // CP H
-			case 0xBD: // CP L
-			case 0xBF: // CP A
-				r1 = opcode & 0x07;
-				pCpu->FLAG_bits.N = 1;
-				pCpu->FLAG_bits.H = (pCpu->A & 0x0F) < (pCpu->reg[r1]->R & 0x0F);
-				pCpu->FLAG_bits.C = (pCpu->A & 0xF0) < (pCpu->reg[r1]->R & 0xF0);
-				pCpu->FLAG_bits.Z = pCpu->A == pCpu->reg[r1]->R;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xBE: // CP (HL)
-				pCpu->address_bus = pCpu->HL;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 1;
-				pCpu->FLAG_bits.H = (pCpu->A & 0x0F) < (pCpu->data_bus & 0x0F);
-				pCpu->FLAG_bits.C = (pCpu->A & 0xF0) < (pCpu->data_bus & 0xF0);
-				pCpu->FLAG_bits.Z = pCpu->A == pCpu->data_bus;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xFE: // CP n
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				pCpu->FLAG_bits.N = 1;
-				pCpu->FLAG_bits.H = (pCpu->A & 0x0F) < (pCpu->data_bus & 0x0F);
-				pCpu->FLAG_bits.C = (pCpu->A & 0xF0) < (pCpu->data_bus & 0xF0);
-				pCpu->FLAG_bits.Z = pCpu->A == pCpu->data_bus;
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
+static uint8_t cpu_OpSwap(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // SWAP
+	uint8_t r1;
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.N = 0;
+	pCpu->FLAG_bits.H = 0;
+	pCpu->FLAG_bits.C = 0;
+
+	r1 = opcode & 0x07;
+	if (r1 != 0x06){
+		SWAP(CPU_REG(pCpu, r1).R);
+		pCpu->FLAG_bits.Z = !(CPU_REG(pCpu, r1).R);
+	}else{
+		pCpu->address_bus = pCpu->HL;
+		cpu_GetByte(pCpu);
+		SWAP(pCpu->data_bus);
+		pCpu->FLAG_bits.Z = !(pCpu->data_bus);
+	}
+	return CPU_OP_NEXT;
+}
 
-			/* Rotate Instructions */
-			case 0x0F: // RRCA - 9 bit rotate right
-				dummy = pCpu->FLAG_bits.C;
-				pCpu->FLAG_bits.C = pCpu->A & 0x01;
-				pCpu->FLAG_bits.H = 0;
-				pCpu->FLAG_bits.N = 0;
-				pCpu->A = (pCpu->A >> 1 & 0x7F) | dummy << 7;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0x1F: // RRA
-				pCpu->FLAG_bits.C = pCpu->A & 0x01;
-				pCpu->FLAG_bits.H = 0;
-				pCpu->FLAG_bits.N = 0;
-				pCpu->A = (pCpu->A >> 1 & 0x7F) | pCpu->FLAG_bits.C << 7;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0x07: // RLCA - 9 bit rotate left
-				dummy = pCpu->FLAG_bits.C;
-				pCpu->FLAG_bits.C = pCpu->A & 0x80;
-				pCpu->FLAG_bits.H = 0;
-				pCpu->FLAG_bits.N = 0;
-				pCpu->A = (pCpu->A << 1 & 0xFE) | dummy;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0x17: // RLA - 8 bit rotate left
-				pCpu->FLAG_bits.C = pCpu->A & 0x80;
-				pCpu->FLAG_bits.H = 0;
-				pCpu->FLAG_bits.N = 0;
-				pCpu->A = (pCpu->A << 1 & 0xFE) | pCpu->FLAG_bits.C;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+static uint8_t cpu_OpSrl(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // SRL
+	uint8_t r1;
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.N = 0;
+	pCpu->FLAG_bits.H = 0;
+
+	r1 = opcode & 0x07;
+	if (r1 != 0x06){
+		pCpu->FLAG_bits.C = CPU_REG(pCpu, r1).R_bits.bit_0;
+		CPU_REG(pCpu, r1).R = 0x7F & (CPU_REG(pCpu, r1).R >> 1);
+		pCpu->FLAG_bits.Z = CPU_REG(pCpu, r1).R == 0;
+	}else{
+		pCpu->address_bus = pCpu->HL;
+		cpu_GetByte(pCpu);
+		pCpu->FLAG_bits.C = pCpu->data_bus & 0x01;
+		cpu_SetByte(pCpu, 0x7F & (pCpu->data_bus >> 1));
+		pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
+	}
+	return CPU_OP_NEXT;
+}
 
-			/* Stop instruction */
-			case 0x10: // STOP
-				pCpu->stop = 1;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+static uint8_t cpu_OpBit(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // BIT 0 - 7
+	uint8_t r1, bit, mask;
+	cpu_SyncF(pCpu);
+	pCpu->FLAG_bits.N = 0;
+	pCpu->FLAG_bits.H = 1;
+	bit = (opcode & 0x38) >> 3;
+	mask = 1 << bit;
+	r1 = opcode & 0x07;
+	if (r1 != 0x06)
+		pCpu->FLAG_bits.Z = !(CPU_REG(pCpu, r1).R & mask);
+	else{
+		pCpu->address_bus = pCpu->HL;
+		cpu_GetByte(pCpu);
+		pCpu->FLAG_bits.Z = !(pCpu->data_bus & mask);
+	}
+	return CPU_OP_NEXT;
+}
 
-			/* Halt instruction */
-			case 0x76:
-				pCpu->halt = 1;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+static uint8_t cpu_OpRes(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // RES 0 - 7
+	uint8_t r1, bit, mask;
+	bit = opcode & 0x38 >> 3;
+	mask = 1 << bit;
+	r1 = opcode & 0x07;
+	if (r1 != 0x06)
+		CPU_REG(pCpu, r1).R &= ~mask;
+	else{
+		pCpu->address_bus = pCpu->HL;
+		cpu_GetByte(pCpu);
+		cpu_SetByte(pCpu, pCpu->data_bus & ~mask);
+	}
+	return CPU_OP_NEXT;
+}
 
-			/* Jump relatif instructions */
-			case 0x18: // JR n
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				pCpu->PC += 2;
-				pCpu->PC += (int8_t)pCpu->data_bus;
-				jump = 1;
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0x20: // JR NZ
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				if (pCpu->FLAG_bits.Z == 0){
-					pCpu->PC += 2;
-					pCpu->PC += (int8_t)pCpu->data_bus;
-					jump = 1;
-				}
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0x28: // JR Z
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				if (pCpu->FLAG_bits.Z){
-					pCpu->PC += 2;
-					pCpu->PC += (int8_t)pCpu->data_bus;
-					jump = 1;
-				}
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0x30: // JR NC
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				if (pCpu->FLAG_bits.C == 0){
-					pCpu->PC += 2;
-					pCpu->PC += (int8_t)pCpu->data_bus;
-					jump = 1;
-				}
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0x38: // JR C
-				pCpu->address_bus = pCpu->PC + 1;
-				byte = cpu_GetByte(pCpu);
-				if (pCpu->FLAG_bits.C){
-					pCpu->PC += 2;
-					pCpu->PC += (int8_t)pCpu->data_bus;
-					jump = 1;
-				}
-				DEBUG_PRINTF(page0[opcode].mnemonic, pCpu->data_bus);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, pCpu->data_bus);
-				DEBUG_PRINTF("\t");
-				break;
+static uint8_t cpu_OpSet(Cpu *pCpu, uint8_t opcode, uint16_t operand){ // SET 0 - 7
+	uint8_t r1, bit, mask;
+	bit = opcode & 0x38 >> 3;
+	mask = 1 << bit;
+	r1 = opcode & 0x07;
+	if (r1 != 0x06)
+		CPU_REG(pCpu, r1).R |= mask;
+	else{
+		pCpu->address_bus = pCpu->HL;
+		cpu_GetByte(pCpu);
+		cpu_SetByte(pCpu, pCpu->data_bus | mask);
+	}
+	return CPU_OP_NEXT;
+}
 
-			/* Jump absolute instructions */
-			case 0xC3: // JP nnnn
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				pCpu->PC = word;
-				jump = 1;
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0xC2: // JP NZ, nnnn
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				if (pCpu->FLAG_bits.Z == 0){
-					pCpu->PC = word;
-					jump = 1;
-				}
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0xCA: // JP Z, nnnn
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				if (pCpu->FLAG_bits.Z){
-					pCpu->PC = word;
-					jump = 1;
-				}
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0xD2: // JP NC, nnnn
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				if (pCpu->FLAG_bits.C == 0){
-					pCpu->PC = word;
-					jump = 1;
-				}
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0xDA: // JP C, nnnn
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				if (pCpu->FLAG_bits.C){
-					pCpu->PC = word;
-					jump = 1;
-				}
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0xE9: // JP (HL)
-				pCpu->PC = pCpu->HL;
-				jump = 1;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+/*
+	Opcode table
+
+	512 entries, page0 opcodes at [$000; $0FF] and page1 (0xCB prefix)
+	opcodes at [$100; $1FF]. Sizes and clock cycles are taken from the
+	page0/page1 metadata, handlers are assigned per instruction family.
+*/
+
+// Handler families, the order is used by the threaded dispatch labels
+#define CPU_HANDLER_LIST(X) \
+	X(Nop) X(IncWord) X(IncHLInd) X(IncReg) X(DecReg) X(DecHLInd) X(DecWord) \
+	X(AddReg) X(AddHLInd) X(AddImm) X(AddSP) X(AddHL) X(AdcReg) X(AdcHLInd) \
+	X(SubReg) X(SubHLInd) X(SubImm) X(SbcReg) X(SbcHLInd) X(SbcImm) \
+	X(LdRegImm) X(LdHLIndImm) X(LdWordImm) X(LdWordIndA) X(LdHLIndA) X(LdImmIndA) \
+	X(LdImmIndSP) X(LdAWordInd) X(LdAImmInd) X(LdRegReg) X(LdHLIndReg) X(LdRegHLInd) \
+	X(LdHLIncDecA) X(LdAHLIncDec) X(LdhImmA) X(LdCIndA) X(LdhAImm) X(LdACInd) \
+	X(LdHLSPImm) X(LdSPHL) X(AndReg) X(AndHLInd) X(AndImm) X(XorReg) X(XorHLInd) \
+	X(XorImm) X(OrReg) X(OrHLInd) X(OrImm) X(CpReg) X(CpHLInd) X(CpImm) \
+	X(Rrca) X(Rra) X(Rlca) X(Rla) X(Stop) X(Halt) X(Jr) X(JrCond) X(Jp) X(JpCond) \
+	X(JpHL) X(Call) X(CallCond) X(RetCond) X(Ret) X(Reti) X(Rst) X(Pop) X(PopAF) \
+	X(Push) X(PushAF) X(Daa) X(Cpl) X(Scf) X(Ccf) X(Di) X(Ei) X(Illegal) X(Unknown) \
+	X(Rlc) X(Rrc) X(Rl) X(Rr) X(Sla) X(Sra) X(Swap) X(Srl) X(Bit) X(Res) X(Set)
+
+#define CPU_HANDLER_ENUM(name) OP_##name,
+#define CPU_HANDLER_FUNC(name) cpu_Op##name,
+
+enum CPU_HANDLER{
+	CPU_HANDLER_LIST(CPU_HANDLER_ENUM)
+	OP_COUNT
+};
+
+static const Cpu_Handler cpu_handlers[OP_COUNT] = {
+	CPU_HANDLER_LIST(CPU_HANDLER_FUNC)
+};
+
+static Cpu_Opcode cpu_opcodes[CPU_OPCODES];
+
+// Returns handler family of a page0 opcode
+static uint8_t cpu_Page0Family(uint8_t opcode){
+	uint8_t hi = opcode >> 6;
+	uint8_t r1 = (opcode & 0x38) >> 3;
+	uint8_t r2 = opcode & 0x07;
+
+	if (page0[opcode].type == ILLEGAL)
+		return OP_Illegal;
+
+	if (hi == 1){ // $40 - $7F
+		if (opcode == 0x76)
+			return OP_Halt;
+		if (r1 == 6)
+			return OP_LdHLIndReg;
+		if (r2 == 6)
+			return OP_LdRegHLInd;
+		return OP_LdRegReg;
+	}
+	if (hi == 2){ // $80 - $BF, ALU A, r
+		static const uint8_t alu_reg[8] = {OP_AddReg, OP_AdcReg, OP_SubReg, OP_SbcReg, OP_AndReg, OP_XorReg, OP_OrReg, OP_CpReg};
+		static const uint8_t alu_ind[8] = {OP_AddHLInd, OP_AdcHLInd, OP_SubHLInd, OP_SbcHLInd, OP_AndHLInd, OP_XorHLInd, OP_OrHLInd, OP_CpHLInd};
+		return r2 == 6 ? alu_ind[r1] : alu_reg[r1];
+	}
 
-			/* Call instructions */
-			case 0xCD: // CALL nnnn
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				cpu_Push(pCpu, pCpu->PC + page0[opcode].size);
-				pCpu->PC = word;
-				jump = 1;
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0xC4: // CALL NZ, nnnn
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				if (pCpu->FLAG_bits.Z == 0){
-					cpu_Push(pCpu, pCpu->PC + page0[opcode].size);
-					pCpu->PC = word;
-					jump = 1;
-				}
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0xCC: // CALL Z, nnnn
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				if (pCpu->FLAG_bits.Z){
-					cpu_Push(pCpu, pCpu->PC + page0[opcode].size);
-					pCpu->PC = word;
-					jump = 1;
-				}
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0xD4: // CALL NC, nnnn
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				if (pCpu->FLAG_bits.C == 0){
-					cpu_Push(pCpu, pCpu->PC + page0[opcode].size);
-					pCpu->PC = word;
-					jump = 1;
-				}
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
-			case 0xDC: // CALL C, nnnn
-				pCpu->address_bus = pCpu->PC + 1;
-				word = cpu_GetWordFromPC(pCpu);
-				if (pCpu->FLAG_bits.C){
-					cpu_Push(pCpu, pCpu->PC + page0[opcode].size);
-					pCpu->PC = word;
-					jump = 1;
-				}
-				DEBUG_PRINTF(page0[opcode].mnemonic, word);
-				DEBUG_PRINTF("\t\t");
-				DEBUG_PRINTF(page0[opcode].description, word);
-				DEBUG_PRINTF("\t");
-				break;
+	switch (opcode){
+		case 0x00: return OP_Nop;
+		case 0x03: case 0x13: case 0x23: case 0x33: return OP_IncWord;
+		case 0x0B: case 0x1B: case 0x2B: case 0x3B: return OP_DecWord;
+		case 0x09: case 0x19: case 0x29: case 0x39: return OP_AddHL;
+		case 0x01: case 0x11: case 0x21: case 0x31: return OP_LdWordImm;
+		case 0x34: return OP_IncHLInd;
+		case 0x35: return OP_DecHLInd;
+		case 0x36: return OP_LdHLIndImm;
+		case 0x02: case 0x12: return OP_LdWordIndA;
+		case 0x0A: case 0x1A: return OP_LdAWordInd;
+		case 0x22: case 0x32: return OP_LdHLIncDecA;
+		case 0x2A: case 0x3A: return OP_LdAHLIncDec;
+		case 0x08: return OP_LdImmIndSP;
+		case 0x07: return OP_Rlca;
+		case 0x0F: return OP_Rrca;
+		case 0x17: return OP_Rla;
+		case 0x1F: return OP_Rra;
+		case 0x10: return OP_Stop;
+		case 0x18: return OP_Jr;
+		case 0x20: case 0x28: case 0x30: case 0x38: return OP_JrCond;
+		case 0x27: return OP_Daa;
+		case 0x2F: return OP_Cpl;
+		case 0x37: return OP_Scf;
+		case 0x3F: return OP_Ccf;
+		case 0xC6: return OP_AddImm;
+		case 0xD6: return OP_SubImm;
+		case 0xDE: return OP_SbcImm;
+		case 0xE6: return OP_AndImm;
+		case 0xEE: return OP_XorImm;
+		case 0xF6: return OP_OrImm;
+		case 0xFE: return OP_CpImm;
+		case 0xE8: return OP_AddSP;
+		case 0xC3: return OP_Jp;
+		case 0xC2: case 0xCA: case 0xD2: case 0xDA: return OP_JpCond;
+		case 0xE9: return OP_JpHL;
+		case 0xCD: return OP_Call;
+		case 0xC4: case 0xCC: case 0xD4: case 0xDC: return OP_CallCond;
+		case 0xC9: return OP_Ret;
+		case 0xC0: case 0xC8: case 0xD0: case 0xD8: return OP_RetCond;
+		case 0xD9: return OP_Reti;
+		case 0xC7: case 0xCF: case 0xD7: case 0xDF:
+		case 0xE7: case 0xEF: case 0xF7: case 0xFF: return OP_Rst;
+		case 0xC1: case 0xD1: case 0xE1: return OP_Pop;
+		case 0xF1: return OP_PopAF;
+		case 0xC5: case 0xD5: case 0xE5: return OP_Push;
+		case 0xF5: return OP_PushAF;
+		case 0xE0: return OP_LdhImmA;
+		case 0xF0: return OP_LdhAImm;
+		case 0xE2: return OP_LdCIndA;
+		case 0xF2: return OP_LdACInd;
+		case 0xEA: return OP_LdImmIndA;
+		case 0xFA: return OP_LdAImmInd;
+		case 0xF8: return OP_LdHLSPImm;
+		case 0xF9: return OP_LdSPHL;
+		case 0xF3: return OP_Di;
+		case 0xFB: return OP_Ei;
+	}
+	if (hi == 0 && r2 == 4)
+		return OP_IncReg;
+	if (hi == 0 && r2 == 5)
+		return OP_DecReg;
+	if (hi == 0 && r2 == 6)
+		return OP_LdRegImm;
+	return OP_Unknown;
+}
 
-			/* Return instructions */
-			case 0xC0: // RET NZ
-				if (pCpu->FLAG_bits.Z == 0){
-					word = cpu_Pop(pCpu);
-					pCpu->PC = word;
-					jump = 1;
-				}
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xC8: // RET Z
-				if (pCpu->FLAG_bits.Z){
-					word = cpu_Pop(pCpu);
-					pCpu->PC = word;
-					jump = 1;
-				}
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xC9: // RET
-				word = cpu_Pop(pCpu);
-				pCpu->PC = word;
-				jump = 1;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xD0: // RET NC
-				if (pCpu->FLAG_bits.C == 0){
-					word = cpu_Pop(pCpu);
-					pCpu->PC = word;
-					jump = 1;
-				}
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xD8: // RET C
-				if (pCpu->FLAG_bits.C){
-					word = cpu_Pop(pCpu);
-					pCpu->PC = word;
-					jump = 1;
-				}
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xD9: // RETI
-				// Restore master interrupt enable flag to its pre-interrupt status
-				// TODO RETI
-				DEBUG_PRINTF("TODO RETI\n");
-				break;
+// Returns 1 for handler families ending a decoded block: control flow and Cpu state changes
+static uint8_t cpu_BlockEnd(uint8_t family){
+	switch (family){
+		case OP_Stop: case OP_Halt: case OP_Jr: case OP_JrCond: case OP_Jp: case OP_JpCond:
+		case OP_JpHL: case OP_Call: case OP_CallCond: case OP_RetCond: case OP_Ret: case OP_Reti:
+		case OP_Rst: case OP_Di: case OP_Ei: case OP_Illegal: case OP_Unknown:
+			return 1;
+		default:
+			return 0;
+	}
+}
 
-			/* Reset instructions */
-			case 0xC7: // RST $0000
-			case 0xCF: // RST $0008
-			case 0xD7: // RST $0010
-			case 0xDF: // RST $0018
-			case 0xE7: // RST $0020
-			case 0xEF: // RST $0028
-			case 0xF7: // RST $0030
-			case 0xFF: // RST $0038
-				cpu_Push(pCpu, pCpu->PC);
-				r1 = (((opcode & 0xF0) >> 4) - 0xC) * 0x10 + ((opcode & 0x0F) == 0x0F ? 0x08 : 0x00);
-				pCpu->PC = r1;
-				jump = 1;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+// Returns 1 for opcodes reading or writing memory other than their own bytes
+static uint8_t cpu_MemoryAccess(uint8_t family, uint16_t idx){
+	switch (family){
+		case OP_IncHLInd: case OP_DecHLInd: case OP_AddHLInd: case OP_AdcHLInd: case OP_SubHLInd:
+		case OP_SbcHLInd: case OP_AndHLInd: case OP_XorHLInd: case OP_OrHLInd: case OP_CpHLInd:
+		case OP_LdHLIndImm: case OP_LdWordIndA: case OP_LdHLIndA: case OP_LdImmIndA: case OP_LdImmIndSP:
+		case OP_LdAWordInd: case OP_LdAImmInd: case OP_LdHLIndReg: case OP_LdRegHLInd: case OP_LdHLIncDecA:
+		case OP_LdAHLIncDec: case OP_LdhImmA: case OP_LdCIndA: case OP_LdhAImm: case OP_LdACInd:
+		case OP_Call: case OP_CallCond: case OP_RetCond: case OP_Ret: case OP_Reti: case OP_Rst:
+		case OP_Pop: case OP_PopAF: case OP_Push: case OP_PushAF:
+			return 1;
+		default: // page1 opcodes on (HL)
+			return (idx & CPU_PAGE1) && (idx & 0x07) == 6;
+	}
+}
 
-			/* Pop instructions */
-			case 0xC1: // POP BC
-			case 0xD1: // POP DE
-			case 0xE1: // POP HL
-				r1 = (opcode & 0x30) >> 4;
-				(*pCpu->dreg[r1]) = cpu_Pop(pCpu);
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xF1: // POP AF
-				pCpu->AF = cpu_Pop(pCpu);
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+void cpu_InitOpcodeTable(void){
+	static const uint8_t page1_family[0x20] = {
+		OP_Rlc, OP_Rrc, OP_Rl, OP_Rr, OP_Sla, OP_Sra, OP_Swap, OP_Srl,
+		OP_Bit, OP_Bit, OP_Bit, OP_Bit, OP_Bit, OP_Bit, OP_Bit, OP_Bit,
+		OP_Res, OP_Res, OP_Res, OP_Res, OP_Res, OP_Res, OP_Res, OP_Res,
+		OP_Set, OP_Set, OP_Set, OP_Set, OP_Set, OP_Set, OP_Set, OP_Set
+	};
+	uint16_t i;
+	Cpu_Opcode *op;
+
+	for (i = 0; i < 0x100; i++){
+		op = &cpu_opcodes[i];
+		op->family = cpu_Page0Family(i);
+		op->handler = cpu_handlers[op->family];
+		op->size = page0[i].size;
+		op->clock_cycles = page0[i].clock_cycles;
+		op->operand_size = op->size > 1 ? op->size - 1 : 0;
+		op->block_end = cpu_BlockEnd(op->family);
+		op->memory = cpu_MemoryAccess(op->family, i);
+		op->mnemonic = page0[i].mnemonic;
+
+		op = &cpu_opcodes[CPU_PAGE1 | i];
+		op->family = page1_family[i >> 3];
+		op->handler = cpu_handlers[op->family];
+		op->size = page1[i].size;
+		op->clock_cycles = page1[i].clock_cycles;
+		op->operand_size = 0;
+		op->block_end = 0;
+		op->memory = cpu_MemoryAccess(op->family, CPU_PAGE1 | i);
+		op->mnemonic = page1[i].mnemonic;
+	}
+}
 
-			/* Push instructions */
-			case 0xC5: // Push BC
-			case 0xD5: // Push DE
-			case 0xE5: // Push HL
-				r1 = (opcode & 0x30) >> 4;
-				cpu_Push(pCpu, (*pCpu->dreg[r1]));
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xF5: // Push AF
-				cpu_Push(pCpu, pCpu->AF);
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+const Cpu_Opcode* cpu_GetOpcode(uint16_t idx){
+	return &cpu_opcodes[idx];
+}
 
-			/* Decimal Adjust instruction */
-			case 0x27: // DAA
-				if (((pCpu->A & 0x0F) > 0x09) || pCpu->FLAG_bits.H)
-					pCpu->A += 0x06;
-				if (((pCpu->A & 0xF0) > 0x90) || pCpu->FLAG_bits.C){
-					pCpu->A += 0x60;
-					pCpu->FLAG_bits.C = 1;
-				}else{
-					pCpu->FLAG_bits.C = 0;
-				}
-				pCpu->FLAG_bits.H = 0;
-				pCpu->FLAG_bits.Z = pCpu->A == 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+const char* cpu_GetFamilyName(uint8_t family){
+	#define CPU_HANDLER_NAME(name) #name,
+	static const char *names[OP_COUNT] = {
+		CPU_HANDLER_LIST(CPU_HANDLER_NAME)
+	};
+	#undef CPU_HANDLER_NAME
+	return family < OP_COUNT ? names[family] : NULL;
+}
 
-			/* Complement instruction */
-			case 0x2F: // CPL
-				pCpu->A = ~pCpu->A;
-				pCpu->FLAG_bits.N = 1;
-				pCpu->FLAG_bits.H = 1;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+// Append executed instruction and register state to the attached trace
+static void cpu_TraceRecord(Cpu *pCpu, uint16_t pc, uint16_t idx, uint16_t operand){
+	Trace_Record *rec = trace_Next(pCpu->trace);
+	cpu_SyncF(pCpu);
+	rec->clock_cycle = pCpu->clock_cycle;
+	rec->PC = pc;
+	rec->opcode = idx;
+	rec->operand = operand;
+	rec->AF = pCpu->AF;
+	rec->BC = pCpu->BC;
+	rec->DE = pCpu->DE;
+	rec->HL = pCpu->HL;
+	rec->SP = pCpu->SP;
+	return;
+}
 
-			/* Carry set/reset instructions */
-			case 0x37: // SCF
-				pCpu->FLAG_bits.C = 1;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0x3F: // CCF
-				pCpu->FLAG_bits.C = 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+// Execute a decoded instruction at PC
+static inline void cpu_Exec(Cpu *pCpu, uint16_t idx, uint16_t operand){
+	const Cpu_Opcode *op = &cpu_opcodes[idx];
+	const uint16_t pc = pCpu->PC;
+	uint8_t jump;
+
+#if defined(CPU_THREADED_DISPATCH) && defined(__GNUC__)
+	// Threaded dispatch, jump straight to the handler family label
+	#define CPU_HANDLER_LABEL(name) &&label_##name,
+	#define CPU_HANDLER_CASE(name) label_##name: jump = cpu_Op##name(pCpu, idx & 0xFF, operand); goto dispatched;
+	{
+		static void *labels[OP_COUNT] = {
+			CPU_HANDLER_LIST(CPU_HANDLER_LABEL)
+		};
+		goto *labels[op->family];
+		CPU_HANDLER_LIST(CPU_HANDLER_CASE)
+	}
+dispatched:
+	#undef CPU_HANDLER_LABEL
+	#undef CPU_HANDLER_CASE
+#else
+	jump = op->handler(pCpu, idx & 0xFF, operand);
+#endif
+
+	// increase clock cycle and PC
+	pCpu->clock_cycle += op->clock_cycles;
+	if (jump == CPU_OP_NEXT && !pCpu->halt && !pCpu->stop)
+		pCpu->PC += op->size;
+
+	// Binary trace, one record per instruction, decoded by tools/trace_decode
+	if (pCpu->trace)
+		cpu_TraceRecord(pCpu, pc, idx, operand);
+}
 
-			/* Disable/Enable Interrupt instruction */
-			// TODO : check if this is correct
-			case 0xF3:
-				pCpu->ie_reg->IE = 0;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
-			case 0xFB:
-				pCpu->ie_reg->IE = 0xFF;
-				DEBUG_PRINTF("%s\t\t%s\t", page0[opcode].mnemonic, page0[opcode].description);
-				break;
+// Execute a decoded instruction and account it in the attached profiler
+static void cpu_ExecProfile(Cpu *pCpu, uint16_t idx, uint16_t operand){
+	const uint64_t ticks = prof_Ticks();
+	cpu_Exec(pCpu, idx, operand);
+	prof_Record(pCpu->prof, idx, cpu_opcodes[idx].clock_cycles, prof_Ticks() - ticks);
+	return;
+}
 
-			/* Illegal instructions */
-			case 0xD3:
-			case 0xDB:
-			case 0xDD:
-			case 0xE3:
-			case 0xE4:
-			case 0xEB:
-			case 0xEC:
-			case 0xED:
-			case 0xF4:
-			case 0xFC:
-			case 0xFD:
-				DEBUG_PRINTF("\nIllegal instruction %02X\n", opcode);
-				break;
+// Fetch, decode and execute one instruction
+static inline void cpu_Step(Cpu *pCpu){
+	uint16_t idx;
+	uint16_t operand = 0;
+	const Cpu_Opcode *op;
 
-			default:
-				DEBUG_PRINTF("\nUnknown instruction 0x%02Xnot yet implemented.\n", opcode);
+	// Read opcode first, 0xCB prefix selects page1 in the opcode table
+	pCpu->address_bus = pCpu->PC;
+	cpu_GetByte(pCpu);
+	idx = pCpu->data_bus;
+	if (idx == OPCODE_EXTENDED){
+		pCpu->address_bus = pCpu->PC + 1;
+		cpu_GetByte(pCpu);
+		idx = CPU_PAGE1 | pCpu->data_bus;
+	}
+	op = &cpu_opcodes[idx];
+
+	// Fetch immediate operand
+	if (op->operand_size == 1){
+		pCpu->address_bus = pCpu->PC + 1;
+		cpu_GetByte(pCpu);
+		operand = pCpu->data_bus;
+	}else if (op->operand_size == 2){
+		pCpu->address_bus = pCpu->PC + 1;
+		operand = cpu_GetWordFromPC(pCpu);
+	}
+
+	if (pCpu->prof)
+		cpu_ExecProfile(pCpu, idx, operand);
+	else
+		cpu_Exec(pCpu, idx, operand);
+}
+
+// Returns 1 if blocks can be decoded at address: ROM & BIOS, internal RAM & echo, HRAM
+static inline uint8_t cpu_BlockRegion(uint16_t address){
+	return address < MEM_VIDEO_RAM_OFFSET
+		|| (address >= MEM_RAM_INTERNAL_OFFSET && address < MEM_SPRITE_ATTRI_OFFSET)
+		|| (address >= MEM_HRAM_OFFSET && address < MEM_IE_REG_OFFSET);
+}
+
+// Returns 1 if writes to a RAM host page go to cpu_WriteControl: it holds decoded blocks
+// or it was not written since the last snapshot
+static uint8_t cpu_Trapped(Cpu *pCpu, const uint8_t *pPage){
+	Block_CodePage *code;
+
+	if (pCpu->snap && snap_Clean(pCpu->snap, pPage))
+		return 1;
+	if (!pCpu->blocks)
+		return 0;
+	code = block_FindCodePage(pCpu->blocks, pPage);
+	return code && code->active;
+}
+
+// Trap writes to RAM pages holding decoded blocks or not written since the last snapshot
+static void cpu_ProtectPages(Cpu *pCpu){
+	uint16_t page;
+
+	if (!pCpu->blocks && !pCpu->snap)
+		return;
+	for (page = MEM_VIDEO_RAM_OFFSET / MEM_PAGE_SIZE; page < MEM_IO_PORTS_OFFSET / MEM_PAGE_SIZE; page++)
+		if (pCpu->write_page[page] && cpu_Trapped(pCpu, pCpu->read_page[page]))
+			pCpu->write_page[page] = NULL;
+	return;
+}
+
+// Restore direct writes to the RAM pages mapped on a host page once it is no longer trapped
+static void cpu_UnprotectPage(Cpu *pCpu, const uint8_t *pPage){
+	uint16_t page;
+
+	if (cpu_Trapped(pCpu, pPage))
+		return;
+	for (page = MEM_VIDEO_RAM_OFFSET / MEM_PAGE_SIZE; page < MEM_IO_PORTS_OFFSET / MEM_PAGE_SIZE; page++)
+		if (pCpu->read_page[page] == pPage)
+			pCpu->write_page[page] = pCpu->read_page[page];
+	return;
+}
+
+// Decode instructions at PC into a block, returns 0 if nothing could be decoded
+static uint8_t cpu_BuildBlock(Cpu *pCpu, Block *pBlock, const uint8_t *code){
+	const uint16_t start = pCpu->PC % MEM_PAGE_SIZE;
+	const uint8_t *page = code - start;
+	const Cpu_Opcode *op;
+	Block_CodePage *code_page = NULL;
+	uint16_t offset = start;
+	uint16_t end = MEM_PAGE_SIZE;
+	uint16_t idx, cycles = 0;
+	uint8_t count = 0;
+
+	pBlock->code = NULL;
+	if (!cpu_BlockRegion(pCpu->PC))
+		return 0;
+	if (pCpu->PC >= MEM_HRAM_OFFSET) // stop before interrupt enable register
+		end = MEM_IE_REG_OFFSET % MEM_PAGE_SIZE;
+	// Code in RAM, writes to its bytes drop the block
+	if (pCpu->PC >= MEM_VIDEO_RAM_OFFSET){
+		code_page = block_AddCodePage(pCpu->blocks, page);
+		if (!code_page)
+			return 0;
+	}
+
+	while (count < BLOCK_MAX_OPS && offset < end){
+		idx = page[offset];
+		if (idx == OPCODE_EXTENDED){
+			if (offset + 1 >= end)
 				break;
+			idx = CPU_PAGE1 | page[offset + 1];
+		}
+		op = &cpu_opcodes[idx];
+		if (offset + op->size > end)
+			break;
+		pBlock->ops[count].idx = idx;
+		if (op->operand_size == 1)
+			pBlock->ops[count].operand = page[offset + 1];
+		else if (op->operand_size == 2)
+			pBlock->ops[count].operand = page[offset + 1] | (page[offset + 2] << 8);
+		else
+			pBlock->ops[count].operand = 0;
+		count++;
+		offset += op->size;
+		cycles += op->clock_cycles;
+		if (op->block_end)
+			break;
+	}
+	if (count == 0)
+		return 0;
+
+	if (code_page){
+		block_MarkCode(code_page, start, offset - start);
+		cpu_ProtectPages(pCpu);
+	}
+	pBlock->code = code;
+	pBlock->count = count;
+	pBlock->heat = 0;
+	pBlock->cycles = cycles;
+	pBlock->native = NULL;
+	pBlock->idle_cycles = pCpu->idle ? idle_Detect(pCpu->idle, pBlock) : 0;
+	return 1;
+}
+
+// Interpret decoded block until it ends, its code or the memory map changes or target is reached
+static void cpu_InterpretBlock(Cpu *pCpu, const Block *pBlock, uint64_t target){
+	Block_Cache *cache = pCpu->blocks;
+	const Block_Op *bop, *end;
+
+	cache->stale = 0;
+	for (bop = pBlock->ops, end = bop + pBlock->count; bop < end; bop++){
+		if (pCpu->prof)
+			cpu_ExecProfile(pCpu, bop->idx, bop->operand);
+		else
+			cpu_Exec(pCpu, bop->idx, bop->operand);
+		if (cache->stale || pCpu->halt || pCpu->stop || pCpu->clock_cycle >= target)
+			break;
+	}
+}
+
+// Hash of the mapped pages and every cartridge RAM bank
+static uint32_t cpu_JitHash(const Cpu *pCpu){
+	const Memory *ram = &pCpu->map[MAP_RAM_BANK_SWITCH].mem;
+	uint32_t hash = 0, i;
+	uint16_t page;
+
+	for (page = 0; page < MEM_PAGES; page++)
+		for (i = 0; i < MEM_PAGE_SIZE; i++)
+			hash = hash * 31 + pCpu->read_page[page][i];
+	for (i = 0; i < ram->banks * ram->bank_size; i++)
+		hash = hash * 31 + ram->data[i];
+	return hash;
+}
+
+// Run native block and the interpreter from the same state, count differences
+static void cpu_JitVerify(Cpu *pCpu, Block *pBlock){
+	Jit *jit = pCpu->jit;
+	Cpu *ref = NULL;
+	uint8_t *banks = &jit->snapshot[MEM_TOTAL_SIZE];
+	uint32_t hash_ref = 0, hash = 0, banks_size;
+	uint16_t page;
+
+	ref = (Cpu*)malloc(sizeof(Cpu) * 2);
+	if (!ref)
+		return;
+
+	// Save state, page table included, and every cartridge RAM bank: the block may switch banks
+	ref[0] = *pCpu;
+	for (page = 0; page < MEM_PAGES; page++)
+		memcpy(&jit->snapshot[page * MEM_PAGE_SIZE], pCpu->read_page[page], MEM_PAGE_SIZE);
+	banks_size = pCpu->map[MAP_RAM_BANK_SWITCH].mem.banks * pCpu->map[MAP_RAM_BANK_SWITCH].mem.bank_size;
+	memcpy(banks, pCpu->map[MAP_RAM_BANK_SWITCH].mem.data, banks_size);
+
+	// Host objects follow the native run only, restored with the state
+	pCpu->trace = NULL;
+	pCpu->prof = NULL;
+	pCpu->callprof = NULL;
+	pCpu->serial_out = NULL;
+	pCpu->sram = NULL;
+	cpu_InterpretBlock(pCpu, pBlock, UINT64_MAX);
+	hash_ref = cpu_JitHash(pCpu);
+	cpu_SyncF(pCpu);
+	ref[1] = *pCpu;
+
+	// Restore state and run native code, ROM and bios pages are read only mappings
+	*pCpu = ref[0];
+	for (page = MEM_VIDEO_RAM_OFFSET / MEM_PAGE_SIZE; page < MEM_PAGES; page++)
+		memcpy(pCpu->read_page[page], &jit->snapshot[page * MEM_PAGE_SIZE], MEM_PAGE_SIZE);
+	memcpy(pCpu->map[MAP_RAM_BANK_SWITCH].mem.data, banks, banks_size);
+	pCpu->blocks->stale = 0;
+	((Jit_Block)pBlock->native)(pCpu);
+	hash = cpu_JitHash(pCpu);
+	cpu_SyncF(pCpu);
+
+	jit->verified++;
+	if (pCpu->PC != ref[1].PC || pCpu->SP != ref[1].SP || pCpu->AF != ref[1].AF
+		|| pCpu->BC != ref[1].BC || pCpu->DE != ref[1].DE || pCpu->HL != ref[1].HL
+		|| pCpu->clock_cycle != ref[1].clock_cycle || pCpu->halt != ref[1].halt
+		|| pCpu->stop != ref[1].stop || hash != hash_ref){
+		jit->mismatches++;
+		printf("Jit mismatch at $%04X: PC %04X/%04X AF %04X/%04X BC %04X/%04X DE %04X/%04X HL %04X/%04X SP %04X/%04X\n",
+			ref[0].PC, pCpu->PC, ref[1].PC, pCpu->AF, ref[1].AF, pCpu->BC, ref[1].BC,
+			pCpu->DE, ref[1].DE, pCpu->HL, ref[1].HL, pCpu->SP, ref[1].SP);
+	}
+	free(ref);
+}
+
+// Idle loop jumped back to its start, skip the whole iterations left before target
+static void cpu_SkipIdle(Cpu *pCpu, const Block *pBlock, uint64_t target){
+	struct Idle *idle = pCpu->idle;
+	uint64_t skip;
+
+	if (pCpu->clock_cycle >= target)
+		return;
+	skip = (target - pCpu->clock_cycle) / pBlock->idle_cycles * pBlock->idle_cycles;
+	if (!skip)
+		return;
+	pCpu->clock_cycle += skip;
+	idle->hits++;
+	idle->skipped += skip;
+	return;
+}
+
+// Run decoded block at PC, decode it first on a cache miss
+static void cpu_RunBlock(Cpu *pCpu, uint64_t target){
+	const uint16_t pc = pCpu->PC;
+	Block_Cache *cache = pCpu->blocks;
+	const uint8_t *code = &pCpu->read_page[pCpu->PC / MEM_PAGE_SIZE][pCpu->PC % MEM_PAGE_SIZE];
+	Block *block = block_Get(cache, code);
+
+	if (block->code == code){
+		cache->hits++;
+	}else{
+		cache->misses++;
+		if (!cpu_BuildBlock(pCpu, block, code)){
+			cpu_Step(pCpu);
+			return;
+		}
+	}
+
+	// Native code runs the whole block, only when it ends before target (budget end or next event),
+	// the trace and the profiler need the interpreter
+	if (block->native && !pCpu->trace && !pCpu->prof && pCpu->jit && pCpu->clock_cycle + block->cycles <= target){
+		if (pCpu->jit->verify){
+			cpu_JitVerify(pCpu, block);
+		}else{
+			cache->stale = 0;
+			((Jit_Block)block->native)(pCpu);
 		}
-		// increase clock cycle and PC
-		pCpu->clock_cycle += page0[opcode].clock_cycles;
-		if (!jump && !pCpu->halt && !pCpu->stop)
-			pCpu->PC += page0[opcode].size;
 	}else{
-		DEBUG_PRINTF("$%04X> CB %02X\t%s\t\t%s\t", pCpu->PC, pCpu->data_bus, page1[opcode].mnemonic, page1[opcode].description);
-		switch (opcode & 0xF8){
-			case 0x00: // RLC 9 bit rotate left with carry
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.H = 0;
-				dummy = pCpu->FLAG_bits.C;
-
-				r1 = opcode & 0x07;
-				if (r1 != 0x06){
-					pCpu->FLAG_bits.C = pCpu->reg[r1]->R_bits.bit_7;
-					pCpu->reg[r1]->R = dummy | ((pCpu->reg[r1]->R << 1) & 0xFE);
-					pCpu->FLAG_bits.Z = pCpu->reg[r1]->R == 0;
-				}else{
-					pCpu->address_bus = pCpu->HL;
-					byte = cpu_GetByte(pCpu);
-					if (byte == NULL){
-						DEBUG_PRINTF("\ncpu_GetByte failed\n");
-						return;
-					}
-					pCpu->FLAG_bits.C = pCpu->data_bus & 0x80;
-					(*byte) = dummy | ((pCpu->data_bus << 1) & 0xFE);
-					pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
-				}
-				break;
-			case 0x08: // RRC 9 bit rotate right with carry
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.H = 0;
-				dummy = pCpu->FLAG_bits.C;
-
-				r1 = opcode & 0x07;
-				if (r1 != 0x06){
-					pCpu->FLAG_bits.C = pCpu->reg[r1]->R_bits.bit_0;
-					pCpu->reg[r1]->R = (dummy << 7) | ((pCpu->reg[r1]->R >> 1) & 0x7F);
-					pCpu->FLAG_bits.Z = pCpu->reg[r1]->R == 0;
-				}else{
-					pCpu->address_bus = pCpu->HL;
-					byte = cpu_GetByte(pCpu);
-					if (byte == NULL){
-						DEBUG_PRINTF("\ncpu_GetByte failed\n");
-						return;
-					}
-					pCpu->FLAG_bits.C = pCpu->data_bus & 0x01;
-					(*byte) = (dummy << 7) | ((pCpu->data_bus >> 1) & 0x7F);
-					pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
-				}
-				break;
-			case 0x10: // RL 8 bit rotate left
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.H = 0;
-
-				r1 = opcode & 0x07;
-				if (r1 != 0x06){
-					pCpu->FLAG_bits.C = pCpu->reg[r1]->R_bits.bit_7;
-					pCpu->reg[r1]->R = pCpu->FLAG_bits.C | ((pCpu->reg[r1]->R << 1) & 0xFE);
-					pCpu->FLAG_bits.Z = pCpu->reg[r1]->R == 0;
-				}else{
-					pCpu->address_bus = pCpu->HL;
-					byte = cpu_GetByte(pCpu);
-					if (byte == NULL){
-						DEBUG_PRINTF("\ncpu_GetByte failed\n");
-						return;
-					}
-					pCpu->FLAG_bits.C = pCpu->data_bus & 0x80;
-					(*byte) = pCpu->FLAG_bits.C | ((pCpu->data_bus << 1) & 0xFE);
-					pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
-				}
-				break;
-			case 0x18: // RR 8 bit rotate right
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.H = 0;
-
-				r1 = opcode & 0x07;
-				if (r1 != 0x06){
-					pCpu->FLAG_bits.C = pCpu->reg[r1]->R_bits.bit_0;
-					pCpu->reg[r1]->R = (pCpu->FLAG_bits.C << 7) | ((pCpu->reg[r1]->R >> 1) & 0x7F);
-					pCpu->FLAG_bits.Z = pCpu->reg[r1]->R == 0;
-				}else{
-					pCpu->address_bus = pCpu->HL;
-					byte = cpu_GetByte(pCpu);
-					if (byte == NULL){
-						DEBUG_PRINTF("\ncpu_GetByte failed\n");
-						return;
-					}
-					pCpu->FLAG_bits.C = pCpu->data_bus & 0x01;
-					(*byte) = (pCpu->FLAG_bits.C << 7) | ((pCpu->data_bus >> 1) & 0x7F);
-					pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
-				}
-				break;
-			case 0x20: // SLA
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.H = 0;
-
-				r1 = opcode & 0x07;
-				if (r1 != 0x06){
-					pCpu->FLAG_bits.C = pCpu->reg[r1]->R_bits.bit_7;
-					pCpu->reg[r1]->R = (pCpu->reg[r1]->R << 1) & 0xFE;
-					pCpu->FLAG_bits.Z = pCpu->reg[r1]->R == 0;
-				}else{
-					pCpu->address_bus = pCpu->HL;
-					byte = cpu_GetByte(pCpu);
-					if (byte == NULL){
-						DEBUG_PRINTF("\ncpu_GetByte failed\n");
-						return;
-					}
-					pCpu->FLAG_bits.C = pCpu->data_bus & 0x80;
-					(*byte) = (pCpu->data_bus << 1) & 0xFE;
-					pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
-				}
-				break;
-			case 0x28: // SRA
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.H = 0;
-
-				r1 = opcode & 0x07;
-				if (r1 != 0x06){
-					pCpu->FLAG_bits.C = pCpu->reg[r1]->R_bits.bit_0;
-					pCpu->reg[r1]->R = (0x80 & pCpu->reg[r1]->R) | ((pCpu->reg[r1]->R >> 1) & 0x7F);
-					pCpu->FLAG_bits.Z = pCpu->reg[r1]->R == 0;
-				}else{
-					pCpu->address_bus = pCpu->HL;
-					byte = cpu_GetByte(pCpu);
-					if (byte == NULL){
-						DEBUG_PRINTF("\ncpu_GetByte failed\n");
-						return;
-					}
-					pCpu->FLAG_bits.C = pCpu->data_bus & 0x01;
-					(*byte) = (0x80 & pCpu->data_bus) | ((pCpu->data_bus >> 1) & 0x7F);
-					pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
-				}
-				break;
-			case 0x30: // SWAP
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.H = 0;
-				pCpu->FLAG_bits.C = 0;
+		if (pCpu->jit && block->heat < UINT8_MAX && ++block->heat == pCpu->jit->threshold)
+			jit_Compile(pCpu->jit, pCpu, block);
+		cpu_InterpretBlock(pCpu, block, target);
+	}
 
-#define SWAP(x) (x) = ((((x) & 0xF0) >> 4) | (((x) & 0x0F) << 4))
+	// Polled registers cannot change before target, the next event
+	if (block->idle_cycles && pCpu->PC == pc && pCpu->idle && !pCpu->trace && !pCpu->prof)
+		cpu_SkipIdle(pCpu, block, target);
+}
 
-				r1 = opcode & 0x07;
-				if (r1 != 0x06){
-					SWAP(pCpu->reg[r1]->R);
-					pCpu->FLAG_bits.Z = !(pCpu->reg[r1]->R);
-				}else{
-					pCpu->address_bus = pCpu->HL;
-					byte = cpu_GetByte(pCpu);
-					if (byte == NULL){
-						DEBUG_PRINTF("\ncpu_GetByte failed\n");
-						return;
-					}
-					SWAP(pCpu->data_bus);
-					pCpu->FLAG_bits.Z = !(pCpu->data_bus);
-				}
-				break;
-			case 0x38: // SRL
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.H = 0;
-
-				r1 = opcode & 0x07;
-				if (r1 != 0x06){
-					pCpu->FLAG_bits.C = pCpu->reg[r1]->R_bits.bit_0;
-					pCpu->reg[r1]->R = 0x7F & (pCpu->reg[r1]->R >> 1);
-					pCpu->FLAG_bits.Z = pCpu->reg[r1]->R == 0;
-				}else{
-					pCpu->address_bus = pCpu->HL;
-					byte = cpu_GetByte(pCpu);
-					if (byte == NULL){
-						DEBUG_PRINTF("\ncpu_GetByte failed\n");
-						return;
-					}
-					pCpu->FLAG_bits.C = pCpu->data_bus & 0x01;
-					(*byte) = 0x7F & (pCpu->data_bus >> 1);
-					pCpu->FLAG_bits.Z = pCpu->data_bus == 0;
-				}
-				break;
-			case 0x40: // BIT 0
-			case 0x48: // BIT 1
-			case 0x50: // BIT 2
-			case 0x58: // BIT 3
-			case 0x60: // BIT 4
-			case 0x68: // BIT 5
-			case 0x70: // BIT 6
-			case 0x78: // BIT 7
-				pCpu->FLAG_bits.N = 0;
-				pCpu->FLAG_bits.H = 1;
-				bit = (opcode & 0x38) >> 3;
-				mask = 1 << bit;
-				r1 = opcode & 0x07;
-				if (r1 != 0x06)
-					pCpu->FLAG_bits.Z = !(pCpu->reg[r1]->R & mask);
-				else{
-					pCpu->address_bus = pCpu->HL;
-					byte = cpu_GetByte(pCpu);
-					if (byte == NULL){
-						DEBUG_PRINTF("\ncpu_GetByte failed\n");
-						return;
-					}
-					pCpu->FLAG_bits.Z = !(pCpu->data_bus & mask);
-				}
+// Fire events due at the current clock cycle
+static void cpu_RunEvents(Cpu *pCpu){
+	uint64_t deadline;
+
+	while (pCpu->sched.next <= pCpu->clock_cycle){
+		switch (sched_Pop(&pCpu->sched, &deadline)){
+			case SCHED_EVENT_LCD:
+				lcd_Event(pCpu, deadline);
 				break;
-			case 0x80: // RES 0
-			case 0x88: // RES 1
-			case 0x90: // RES 2
-			case 0x98: // RES 3
-			case 0xA0: // RES 4
-			case 0xA8: // RES 5
-			case 0xB0: // RES 6
-			case 0xB8: // RES 7
-				bit = opcode & 0x38 >> 3;
-				mask = 1 << bit;
-				r1 = opcode & 0x07;
-				if (r1 != 0x06)
-					pCpu->reg[r1]->R &= ~mask;
-				else{
-					pCpu->address_bus = pCpu->HL;
-					byte = cpu_GetByte(pCpu);
-					if (byte == NULL){
-						DEBUG_PRINTF("\ncpu_GetByte failed\n");
-						return;
-					}
-					(*byte) = pCpu->data_bus & ~mask;
-				}
+			case SCHED_EVENT_SERIAL:
+				serial_Event(pCpu, deadline);
 				break;
-			case 0xC0: // SET 0
-			case 0xC8: // SET 1
-			case 0xD0: // SET 2
-			case 0xD8: // SET 3
-			case 0xE0: // SET 4
-			case 0xE8: // SET 5
-			case 0xF0: // SET 6
-			case 0xF8: // SET 7
-				bit = opcode & 0x38 >> 3;
-				mask = 1 << bit;
-				r1 = opcode & 0x07;
-				if (r1 != 0x06)
-					pCpu->reg[r1]->R |= mask;
-				else{
-					pCpu->address_bus = pCpu->HL;
-					byte = cpu_GetByte(pCpu);
-					if (byte == NULL){
-						DEBUG_PRINTF("cpu_GetByte failed\n");
-						return;
-					}
-					(*byte) = pCpu->data_bus | mask;
-				}
+			case SCHED_EVENT_TIMER:
+				timer_Event(pCpu, deadline);
 				break;
-			default:
-				DEBUG_PRINTF("\nunknown instruction #%X\n", opcode);
+			case SCHED_EVENT_PROFILE:
+				callprof_Event(pCpu, deadline);
 				break;
 		}
-		// reset extended mode
-		pCpu->extended = 0;
-		// increase clock cycle and PC
-		pCpu->clock_cycle += page1[opcode].clock_cycles;
-		pCpu->PC += page1[opcode].size;
 	}
+	cpu_UpdateInterrupt(pCpu);
+	return;
+}
+
+// int_pending is set: enable IME after EI, or service the highest priority interrupt
+static void cpu_Interrupt(Cpu *pCpu){
+	uint8_t requested, n;
+
+	if (pCpu->ime_delay){
+		// EI takes effect after the next instruction, DI in it still wins
+		pCpu->ime_delay = 0;
+		pCpu->ime = 1;
+		cpu_Step(pCpu);
+		cpu_UpdateInterrupt(pCpu);
+		return;
+	}
+
+	requested = pCpu->ie_reg->IE & pCpu->sfr->IF & INT_MASK;
+	if (pCpu->ime && requested){
+		for (n = 0; !(requested & (1 << n)); n++);
+		pCpu->sfr->IF &= ~(1 << n);
+		pCpu->ime = 0;
+		cpu_Push(pCpu, pCpu->PC);
+		pCpu->PC = INT_VEC_VBLANK + n * INT_VEC_SPACING;
+		pCpu->clock_cycle += INT_CYCLES;
+		if (pCpu->callprof)
+			callprof_Call(pCpu, pCpu->PC);
+	}
+	cpu_UpdateInterrupt(pCpu);
+	return;
+}
+
+// Halted or stopped Cpu: leave HALT when IE & IF is set, otherwise skip time to the next event
+static void cpu_Idle(Cpu *pCpu, uint64_t target){
+	if (pCpu->halt && (pCpu->ie_reg->IE & pCpu->sfr->IF & INT_MASK)){
+		pCpu->halt = 0;
+		pCpu->PC++; // step over HALT
+		return;
+	}
+	if (pCpu->sched.next < target)
+		target = pCpu->sched.next;
+	if (target == SCHED_NEVER) // nothing can wake the Cpu
+		return;
+	if (pCpu->clock_cycle < target)
+		pCpu->clock_cycle = target;
+	cpu_RunEvents(pCpu);
+	return;
+}
 
-	DEBUG_PRINTF("%02X | %02X | %02X | %02X |", pCpu->A, pCpu->B, pCpu->C, pCpu->D);
-	DEBUG_PRINTF("%02X | %02X | %02X | ", pCpu->E, pCpu->H, pCpu->L);
-	DEBUG_PRINTF("%c%c", pCpu->FLAG_bits.C ? 'C': 'c', pCpu->FLAG_bits.H ? 'H': 'h');
-	DEBUG_PRINTF("%c%c", pCpu->FLAG_bits.N ? 'N': 'n', pCpu->FLAG_bits.Z ? 'Z': 'z');
-	DEBUG_PRINTF("\n");
+void cpu_Run(Cpu *pCpu){
+	if (pCpu->halt || pCpu->stop){
+		cpu_Idle(pCpu, SCHED_NEVER);
+		return;
+	}
+	if (pCpu->int_pending)
+		cpu_Interrupt(pCpu);
+	else
+		cpu_Step(pCpu);
+	cpu_SyncF(pCpu);
+	if (pCpu->clock_cycle >= pCpu->sched.next)
+		cpu_RunEvents(pCpu);
+}
+
+uint32_t cpu_RunCycles(Cpu *pCpu, uint32_t budget){
+	uint64_t start = pCpu->clock_cycle;
+	uint64_t target = start + budget;
+	uint64_t limit;
+
+	while (pCpu->clock_cycle < target){
+		if (pCpu->halt || pCpu->stop){ // nothing to execute, time still passes
+			cpu_Idle(pCpu, target);
+			continue;
+		}
+		if (pCpu->int_pending){
+			cpu_Interrupt(pCpu);
+		}else{
+			// Run uninterrupted up to the next event
+			limit = pCpu->sched.next < target ? pCpu->sched.next : target;
+			if (pCpu->blocks)
+				cpu_RunBlock(pCpu, limit);
+			else
+				cpu_Step(pCpu);
+		}
+		if (pCpu->clock_cycle >= pCpu->sched.next)
+			cpu_RunEvents(pCpu);
+	}
+	cpu_SyncF(pCpu);
+	return pCpu->clock_cycle - start;
 }
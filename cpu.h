@@ -8,6 +8,9 @@
 #include "special_register.h"
 #include "interrupt.h"
 #include "memory_map.h"
+#include "trace.h"
+#include "block.h"
+#include "sched.h"
 
 /*
 
@@ -15,6 +18,8 @@
 
 */
 
+#define CPU_CLOCK_HZ (4194304) // clock cycles per second
+
 // Number of bytes
 #define REG_BYTE (8)
 // Number of words
@@ -53,84 +58,189 @@ union Cpu_Register{
 	}R_bits; // register bits
 };
 
+// Position of byte register B, C, D, E, H, L, F, A (opcode order) in the register file,
+// one nibble per register so the position is a shift and a mask
+#define CPU_R8_POSITIONS (0x98452301u)
+#define CPU_R8(i) ((CPU_R8_POSITIONS >> ((i) << 2)) & 0x0F)
+// Byte register by opcode index, union Cpu_Register lvalue
+#define CPU_REG(pCpu, i) ((pCpu)->r8[CPU_R8(i)])
+// Word register BC, DE, HL, SP, AF by index, uint16_t lvalue
+#define CPU_DREG(pCpu, i) ((pCpu)->r16[i])
+
+// Lazy flag operation kinds
+#define CPU_FLAGS_SYNC (0) // F is up to date
+#define CPU_FLAGS_ADD (1) // ADD, ADC
+#define CPU_FLAGS_SUB (2) // SUB, SBC, CP
+#define CPU_FLAGS_INC (3)
+#define CPU_FLAGS_DEC (4)
+
+struct Jit;
+struct Idle;
+struct Prof;
+struct CallProf;
+struct Serial_Out;
+struct Snap_Pool;
+
 // Cpu structure
 typedef struct{
 	uint64_t clock_cycle; // 4 x machine cycle
 
-	// Cpu work registers
+	// Cpu work registers, flat register file indexed with CPU_REG/CPU_DREG
+	// Memory order (little endian host): C B E D L H SP F A
 	union{
-		uint16_t BC;
-		struct{
-			uint8_t C;
-			uint8_t B;
-		};
-	};
-	union{
-		uint16_t DE;
-		struct{
-			uint8_t E;
-			uint8_t D;
-		};
-	};
-	union{
-		uint16_t HL;
-		struct{
-			uint8_t L;
-			uint8_t H;
-		};
-	};
-	union{
-		uint16_t AF;
+		union Cpu_Register r8[REG_WORD * 2]; // byte view, index with CPU_R8
+		uint16_t r16[REG_WORD]; // word view BC, DE, HL, SP, AF
 		struct{
 			union{
-				uint8_t F;
-				union{
-                    uint8_t FLAG;
-                    struct{
-                        uint8_t unused : 4;
-                        uint8_t C : 1;
-                        uint8_t H : 1;
-                        uint8_t N : 1;
-                        uint8_t Z : 1;
-                    }FLAG_bits;
+				uint16_t BC;
+				struct{
+					uint8_t C;
+					uint8_t B;
 				};
-				union{
-                    uint8_t STATUS;
-                    struct{
-                        uint8_t unused : 4;
-                        uint8_t carry : 1;
-                        uint8_t half_carry : 1;
-                        uint8_t substract : 1;
-                        uint8_t zero : 1;
-                    }STATUS_flags;
+			};
+			union{
+				uint16_t DE;
+				struct{
+					uint8_t E;
+					uint8_t D;
+				};
+			};
+			union{
+				uint16_t HL;
+				struct{
+					uint8_t L;
+					uint8_t H;
+				};
+			};
+			uint16_t SP; // decrements before putting something on the stack
+			union{
+				uint16_t AF;
+				struct{
+					union{
+						uint8_t F;
+						union{
+							uint8_t FLAG;
+							struct{
+								uint8_t unused : 4;
+								uint8_t C : 1;
+								uint8_t H : 1;
+								uint8_t N : 1;
+								uint8_t Z : 1;
+							}FLAG_bits;
+						};
+						union{
+							uint8_t STATUS;
+							struct{
+								uint8_t unused : 4;
+								uint8_t carry : 1;
+								uint8_t half_carry : 1;
+								uint8_t substract : 1;
+								uint8_t zero : 1;
+							}STATUS_flags;
+						};
+					};
+					uint8_t A;
 				};
 			};
-			uint8_t A;
 		};
 	};
-	union Cpu_Register *reg[REG_BYTE]; // register poiner array to help execute instructions
-	uint16_t *dreg[REG_WORD]; // double register array
 
-	uint16_t SP; // decrements before putting something on the stack
+	// Lazy flags, F is stale while flag_op != CPU_FLAGS_SYNC, synced before cpu_Run and cpu_RunCycles return
+	uint8_t flag_op; // kind of the last ALU operation
+	uint8_t flag_a; // operands, index of the alu.h tables
+	uint8_t flag_b;
+	uint8_t flag_c; // carry in of ADD/SUB, kept carry of INC/DEC
+	uint8_t flag_res; // result
+
 	uint16_t PC; // current instruction to execute address
 
 	uint16_t address_bus;
 	uint8_t data_bus;
 
-	uint8_t extended; // extended instruction set flag
-
 	MemoryMap *map;
+	uint8_t *read_page[MEM_PAGES]; // host pointer of each 256 byte page
+	uint8_t *write_page[MEM_PAGES]; // NULL for pages with write side effects
 
 	union Special_Register *sfr;
 	union Interrupt_Enable *ie_reg;
 
 	uint8_t stop; // set by STOP instruction
 	uint8_t halt; // set by HALT instruction
+
+	// Interrupts
+	uint8_t ime; // interrupt master enable
+	uint8_t ime_delay; // set by EI, IME is enabled after the next instruction
+	uint8_t int_pending; // IME & IE & IF or EI pending, only flag checked per instruction
+
+	Scheduler sched; // timed hardware events
+
+	// Timer state, DIV and TIMA are derived from clock_cycle (timer.c)
+	uint64_t div_base; // clock cycle DIV was reset at
+	uint64_t tima_base; // clock cycle TIMA was written or reloaded at
+	uint8_t tima; // TIMA value at tima_base
+
+	uint8_t buttons; // joypad buttons pressed (JOYPAD_*), set with joypad_Set
+
+	// Cartridge mapper registers (mbc.c), banks are selected by the memory map start indexes
+	uint8_t mbc; // MBC_* mapper of the cartridge
+	uint8_t mbc_ram_enable;
+	uint8_t mbc_mode; // MBC1 banking mode, 1 banks RAM and the ROM bank 0 area
+	uint16_t mbc_rom_bank; // ROM bank register, low 5 bits on MBC1
+	uint8_t mbc_ram_bank; // RAM bank register, upper ROM bank bits on MBC1, clock register from 0x08 on MBC3
+	uint8_t mbc_latch; // last write to the MBC3 clock latch
+	uint8_t rtc[5]; // MBC3 clock at rtc_base: seconds, minutes, hours, day low, day high
+	uint8_t rtc_latched[5];
+	uint64_t rtc_base; // clock cycle of rtc, the clock runs on emulated time
+	uint8_t mbc_page[MEM_PAGE_SIZE]; // $A000 - $BFFF without a RAM bank mapped, 0xFF or the clock register
+
+	// Host objects, trace to serial_out, not part of a save state
+	Trace *trace; // execution trace, NULL when tracing is off
+	Block_Cache *blocks; // decoded block cache used by cpu_RunCycles, NULL to interpret every instruction
+	struct Jit *jit; // native code for hot blocks, NULL to interpret blocks
+	struct Idle *idle; // idle loop rules, NULL runs idle loops
+	struct Prof *prof; // opcode profiler, NULL when profiling is off
+	struct CallProf *callprof; // guest call stack profiler, NULL when off
+	struct Snap_Pool *snap; // snapshot pool tracking written RAM pages, NULL when off
+	struct Sram *sram; // battery save file mapped on cartridge RAM, NULL when off
+	struct Serial_Out *serial_out; // bytes sent on the serial port, NULL when not captured
 }Cpu;
 
+// Opcode handler return values
+#define CPU_OP_NEXT (0) // continue with next instruction
+#define CPU_OP_JUMP (1) // PC was set by the instruction
+
+// Opcode table size, page1 (0xCB prefix) opcodes are offset by CPU_PAGE1
+#define CPU_OPCODES (0x200)
+#define CPU_PAGE1 (0x100)
+
+// Opcode handler, gets the opcode and the immediate operand fetched after it
+typedef uint8_t (*Cpu_Handler)(Cpu *pCpu, uint8_t opcode, uint16_t operand);
+
+// Opcode table entry
+typedef struct{
+	Cpu_Handler handler;
+	uint8_t family; // handler family index
+	uint8_t size; // instruction size in bytes
+	uint8_t operand_size; // immediate operand size in bytes
+	uint8_t clock_cycles;
+	uint8_t block_end; // control flow or Cpu state change, ends a decoded block
+	uint8_t memory; // reads or writes memory besides fetching
+	const char *mnemonic; // printf format of the operand
+}Cpu_Opcode;
+
+// Returns opcode table entry, page1 opcodes are offset by CPU_PAGE1
+const Cpu_Opcode* cpu_GetOpcode(uint16_t idx);
+// Returns name of a handler family, NULL past the last family
+const char* cpu_GetFamilyName(uint8_t family);
+
+// Build opcode handler table from page0/page1 metadata, cpu_Init runs it once
+void cpu_InitOpcodeTable(void);
+
 // Initializes and returns a Cpu structure
 Cpu* cpu_Init(void);
-// Free a Cpu structure
+// Initialize a Cpu held by the caller (VM arena) with its MEM_ADDRESS_SPACES memory maps
+void cpu_Setup(Cpu *pCpu, MemoryMap *pMap);
+// Free a Cpu structure from cpu_Init
 void cpu_Free(Cpu *pCpu);
 // Reset Cpu
 void cpu_Reset(Cpu *pCpu);
@@ -139,8 +249,22 @@ void cpu_SetSpecialRegisters(Cpu *pCpu, uint8_t *pMem);
 // Setup interrupt enable register union
 void cpu_SetInterruptEnableRegister(Cpu *pCpu, uint8_t *pMem);
 
+// Recompute int_pending, use after changing IF, IE or IME outside of the Cpu
+void cpu_UpdateInterrupt(Cpu *pCpu);
+
+// Rebuild page table from memory maps, BIOS enable & banks
+void cpu_UpdatePageTable(Cpu *pCpu);
+// Rebuild page table of switchable ROM bank
+void cpu_UpdateRomBankPages(Cpu *pCpu);
+// Rebuild page table of switchable RAM bank
+void cpu_UpdateRamBankPages(Cpu *pCpu);
+// Drop decoded blocks, use after memory was changed outside of the Cpu
+void cpu_FlushBlocks(Cpu *pCpu);
+
 // Returns pointer to byte, value of byte stored in data_bus
 uint8_t* cpu_GetByte(Cpu *pCpu);
+// Write byte at address_bus
+void cpu_SetByte(Cpu *pCpu, uint8_t data);
 // Returns word value from PC, no pointer
 uint16_t cpu_GetWordFromPC(Cpu *pCpu);
 
@@ -149,8 +273,11 @@ uint16_t cpu_Pop(Cpu *pCpu);
 // Opcode push to SP
 void cpu_Push(Cpu *pCpu, uint16_t var);
 
-// Fetch, decode and execute instruction
+// Fetch, decode and execute instruction, a halted Cpu skips to the next event instead
 void cpu_Run(Cpu *pCpu);
+// Execute instructions until budget clock cycles elapsed, returns elapsed clock cycles
+// HALT/STOP skip from event to event, HALT ends when IE & IF is set
+uint32_t cpu_RunCycles(Cpu *pCpu, uint32_t budget);
 
 #endif
 
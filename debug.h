@@ -3,7 +3,8 @@
 
 #include <stdio.h>
 
-#define DEBUG_ENABLE
+// Define DEBUG_ENABLE (-DDEBUG_ENABLE) for debug messages,
+// use a Trace (trace.h) to follow executed instructions
 
 #if defined(DEBUG_ENABLE)
 	#define DEBUG_PRINTF(...) printf(__VA_ARGS__)
@@ -0,0 +1,61 @@
+#include "frontend.h"
+
+Frontend* frontend_Init(void){
+	Frontend *front = NULL;
+
+	front = (Frontend*)malloc(sizeof(Frontend));
+	if (!front)
+		return NULL;
+	if (SDL_Init(SDL_INIT_VIDEO) < 0){
+		free(front);
+		return NULL;
+	}
+	front->w = SDL_CreateWindow("DameGame", 100, 100, LCD_WIDTH, LCD_HEIGHT, SDL_WINDOW_SHOWN);
+	if (!front->w){
+		SDL_Quit();
+		free(front);
+		return NULL;
+	}
+	front->rewind = NULL;
+	front->ws = SDL_GetWindowSurface(front->w);
+	SDL_FillRect(front->ws, &front->ws->clip_rect, 0xFF77EE22);
+	SDL_UpdateWindowSurface(front->w);
+	return front;
+}
+
+void frontend_Run(Frontend *pFront, VM *pVm){
+	while (!(pVm->keys & VM_KEY_EXIT)){
+		if (pFront->rewind && (pVm->keys & VM_KEY_REWIND))
+			rewind_Step(pFront->rewind, pVm);
+		else{
+			vm_RunFrame(pVm);
+			if (pFront->rewind)
+				rewind_Push(pFront->rewind, pVm);
+		}
+		frontend_ReadKeys(pFront, pVm);
+	}
+	return;
+}
+
+void frontend_ReadKeys(Frontend *pFront, VM *pVm){
+	pVm->keys = 0;
+	while (SDL_PollEvent(&pFront->ev)){
+		switch(pFront->ev.type){
+			case SDLK_ESCAPE:
+			case SDL_QUIT:
+				pVm->keys |= VM_KEY_EXIT;
+				break;
+		}
+	}
+	if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_BACKSPACE])
+		pVm->keys |= VM_KEY_REWIND;
+	return;
+}
+
+void frontend_Quit(Frontend *pFront){
+	SDL_FreeSurface(pFront->ws);
+	SDL_DestroyWindow(pFront->w);
+	SDL_Quit();
+	free(pFront);
+	return;
+}
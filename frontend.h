@@ -0,0 +1,38 @@
+#ifndef _FRONTEND_H
+#define _FRONTEND_H
+
+#include <stdint.h>
+#include <SDL2/SDL.h>
+
+#include "vm.h"
+#include "rewind.h"
+
+/*
+
+	SDL front end
+
+	Window and input for a VM, the emulation core does not depend on SDL.
+	Frames run in lockstep with event polling until the window is closed.
+	With a rewind buffer attached every frame is recorded, holding
+	Backspace steps back one frame per frame instead of running.
+
+*/
+
+// Front end structure
+typedef struct{
+	SDL_Window *w;
+	SDL_Surface *ws;
+	SDL_Event ev;
+	Rewind *rewind; // NULL when off
+}Frontend;
+
+// Initialize SDL and open the window, NULL when no display is available
+Frontend* frontend_Init(void);
+// Run VM frames until the window is closed
+void frontend_Run(Frontend *pFront, VM *pVm);
+// Read keys into the VM
+void frontend_ReadKeys(Frontend *pFront, VM *pVm);
+// Close the window and quit SDL
+void frontend_Quit(Frontend *pFront);
+
+#endif
@@ -0,0 +1,66 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "vm.h"
+#include "cli.h"
+
+/*
+	Headless runner, emulation core without SDL or a display
+
+	Runs the bios and cartridge for -n frames (60 by default) as fast as possible and
+	prints the clock cycles run, the host time taken and the idle loop counters.
+*/
+
+#define HEADLESS_FRAMES (60)
+
+// Free the VM, its save file and what the options attached, returns ret
+static int headless_Exit(VM *pVm, Cli *pCli, int ret){
+	vm_Quit(pVm);
+	cli_Free(pCli);
+	return ret;
+}
+
+int main(int argc, char *argv[]){
+	VM *vm = NULL;
+	Cli cli;
+	struct timespec start, end;
+	double seconds;
+	uint64_t cycles;
+
+	vm = vm_Init(cli_VmFlags(argc, argv));
+	if (!vm)
+		return -1;
+	if (cli_Parse(&cli, vm, argc, argv) != 0){
+		cli_Usage(argv[0]);
+		return headless_Exit(vm, &cli, -1);
+	}
+	if (!cli.frames)
+		cli.frames = HEADLESS_FRAMES;
+
+	if (vm_LoadBios(vm, cli.bios_path) != 0){
+		printf("Could not load bios %s\n", cli.bios_path);
+		return headless_Exit(vm, &cli, -1);
+	}
+	if (cli_LoadRom(&cli, vm) != 0)
+		return headless_Exit(vm, &cli, -1);
+	if (cli_LoadState(&cli, vm) != 0)
+		return headless_Exit(vm, &cli, -1);
+
+	cycles = vm->cpu->clock_cycle; // non zero after a state load
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	vm_Run(vm, cli.frames);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	cycles = vm->cpu->clock_cycle - cycles;
+	printf("%u frames, %llu clock cycles in %.3f s, %.1fx real time\n", cli.frames, (unsigned long long)cycles,
+		seconds, seconds > 0 ? cycles / (seconds * CPU_CLOCK_HZ) : 0.0);
+	if (vm->cpu->idle)
+		printf("Idle: %llu loops, %llu skips, %llu clock cycles skipped\n", (unsigned long long)vm->cpu->idle->loops,
+			(unsigned long long)vm->cpu->idle->hits, (unsigned long long)vm->cpu->idle->skipped);
+
+	cli_SaveState(&cli, vm);
+	return headless_Exit(vm, &cli, 0);
+}
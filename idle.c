@@ -0,0 +1,114 @@
+#include "idle.h"
+
+// IO register loads into A
+#define IDLE_LDH_A_N (0xF0) // LDH A, ($FF00 + n)
+#define IDLE_LD_A_NN (0xFA) // LD A, (nn)
+// Relative jumps
+#define IDLE_JR (0x18)
+#define IDLE_JR_COND_MASK (0x1E7) // JR NZ, Z, NC, C
+#define IDLE_JR_COND (0x20)
+
+Idle* idle_Init(void){
+	Idle *idle = NULL;
+
+	idle = (Idle*)calloc(1, sizeof(Idle));
+	if (!idle)
+		return NULL;
+	memset(idle->io, 0xFF, sizeof(idle->io));
+	// Counting with the clock, not on events
+	idle_Allow(idle, MEM_DIV_REG_OFFSET, 0);
+	idle_Allow(idle, MEM_TIMA_REG_OFFSET, 0);
+	return idle;
+}
+
+void idle_Free(Idle *pIdle){
+	free(pIdle);
+	return;
+}
+
+void idle_Allow(Idle *pIdle, uint16_t address, uint8_t allow){
+	uint8_t offset;
+
+	if (address < MEM_IO_PORTS_OFFSET)
+		return;
+	offset = address - MEM_IO_PORTS_OFFSET;
+	if (allow)
+		pIdle->io[offset >> 3] |= 1 << (offset & 7);
+	else
+		pIdle->io[offset >> 3] &= ~(1 << (offset & 7));
+	return;
+}
+
+int8_t idle_AllowRule(Idle *pIdle, const char *rule, uint8_t allow){
+	unsigned long address;
+	char *end;
+
+	if (strcmp(rule, "all") == 0){
+		memset(pIdle->io, allow ? 0xFF : 0x00, sizeof(pIdle->io));
+		return 0;
+	}
+	address = strtoul(rule, &end, 16);
+	if (*end || address < MEM_IO_PORTS_OFFSET || address > 0xFFFF)
+		return -1;
+	idle_Allow(pIdle, address, allow);
+	return 0;
+}
+
+// Returns 1 if address may be polled
+static uint8_t idle_Allowed(const Idle *pIdle, uint16_t address){
+	uint8_t offset;
+
+	if (address < MEM_IO_PORTS_OFFSET)
+		return 0;
+	offset = address - MEM_IO_PORTS_OFFSET;
+	return (pIdle->io[offset >> 3] >> (offset & 7)) & 1;
+}
+
+// Returns 1 if instruction only reads A and writes A and flags
+static uint8_t idle_Test(uint16_t idx){
+	switch (idx){
+		case 0x00: // NOP
+		case 0xFE: case 0xE6: case 0xF6: case 0xEE: // CP n, AND n, OR n, XOR n
+		case 0xBF: case 0xA7: case 0xB7: case 0xAF: // CP A, AND A, OR A, XOR A
+			return 1;
+	}
+	// BIT b, A
+	return (idx & 0x1C7) == (CPU_PAGE1 | 0x47);
+}
+
+uint16_t idle_Detect(Idle *pIdle, const Block *pBlock){
+	const Block_Op *bop = pBlock->ops;
+	const Block_Op *last = &pBlock->ops[pBlock->count - 1];
+	uint16_t cycles = 0, size = 0;
+	uint8_t i;
+
+	if (pBlock->count < 2 || pBlock->count > IDLE_MAX_OPS)
+		return 0;
+
+	// Load of a polled register into A first
+	if (bop->idx == IDLE_LDH_A_N){
+		if (!idle_Allowed(pIdle, MEM_IO_PORTS_OFFSET + bop->operand))
+			return 0;
+	}else if (bop->idx == IDLE_LD_A_NN){
+		if (!idle_Allowed(pIdle, bop->operand))
+			return 0;
+	}else{
+		return 0;
+	}
+
+	for (i = 0; i < pBlock->count; i++){
+		if (i > 0 && &pBlock->ops[i] != last && !idle_Test(pBlock->ops[i].idx))
+			return 0;
+		cycles += cpu_GetOpcode(pBlock->ops[i].idx)->clock_cycles;
+		size += cpu_GetOpcode(pBlock->ops[i].idx)->size;
+	}
+
+	// Relative jump back to the first instruction
+	if (last->idx != IDLE_JR && (last->idx & IDLE_JR_COND_MASK) != IDLE_JR_COND)
+		return 0;
+	if ((int8_t)last->operand != -(int16_t)size)
+		return 0;
+
+	pIdle->loops++;
+	return cycles;
+}
@@ -0,0 +1,58 @@
+#ifndef _IDLE_H
+#define _IDLE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cpu.h"
+#include "block.h"
+
+/*
+
+	Idle loop detection
+
+	Busy-wait loops polling an IO register, such as
+
+		loop: LDH A, ($44)
+		      CP $90
+		      JR NZ, loop
+
+	have no side effect and read values that only change when a scheduled
+	event fires. A decoded block is an idle loop when it:
+		- starts with a load of A from an allowed address of $FF00 - $FFFF
+		- then only tests or masks A (CP, AND, OR, XOR with n or A, BIT b, A, NOP)
+		- ends with a relative jump (JR, JR cc) back to its first instruction
+
+	When such a block jumps back to its start the Cpu adds the clock cycles
+	of every whole iteration left before the next event, the result is
+	exactly the one of running them.
+
+	The rule set is the bitmap of addresses a loop may poll. Registers
+	changing with the clock instead of on events (DIV, TIMA) are not
+	allowed by default. The front ends change the rules with -i/-I and
+	report the counters.
+
+*/
+
+#define IDLE_MAX_OPS (8)
+
+// Idle loop rules and counters
+typedef struct Idle{
+	uint8_t io[MEM_IO_PORTS_SIZE / 8]; // bitmap of $FF00 - $FFFF addresses a loop may poll
+	uint64_t loops; // blocks detected as idle loops
+	uint64_t hits; // times iterations were skipped
+	uint64_t skipped; // clock cycles skipped
+}Idle;
+
+// Initialize and return default rules, every IO port but DIV and TIMA
+Idle* idle_Init(void);
+// Free rules
+void idle_Free(Idle *pIdle);
+// Allow or forbid polling of an IO address in idle loops
+void idle_Allow(Idle *pIdle, uint16_t address, uint8_t allow);
+// Allow or forbid a command line rule, a hex address or "all", returns -1 on a bad rule
+int8_t idle_AllowRule(Idle *pIdle, const char *rule, uint8_t allow);
+// Returns clock cycles of one iteration when block is an idle loop, 0 otherwise
+uint16_t idle_Detect(Idle *pIdle, const Block *pBlock);
+
+#endif
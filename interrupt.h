@@ -8,19 +8,23 @@
 #define INT_VEC_SERIAL_TRANSFER (0x0058)
 #define INT_VEC_P1_IO (0x0060)
 
+#define INT_MASK (0x1F) // interrupt bits of IE and IF
+#define INT_VEC_SPACING (0x08) // vectors follow IF bit order, bit 0 has the highest priority
+#define INT_CYCLES (20) // clock cycles to push PC and jump to the vector
+
 /*
 	When an interrupt is used a '0' should be stored in the IF register
 	before the IE register is set.
 */
 
 // Interrupt Priority enumeration
-enum{
+enum Int_Priority{
 	prio_vblank = 1,
 	prio_lcdc,
 	prio_timer_overflow,
 	prio_serial_transfer,
 	prio_p1_io
-}Int_Priority;
+};
 
 /*
 	Use as union Interrupt_Enable *ie_reg;
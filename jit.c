@@ -0,0 +1,260 @@
+#include <stddef.h>
+#include "jit.h"
+
+#if defined(JIT_X86_64)
+	#include <sys/mman.h>
+#endif
+
+Jit* jit_Init(uint8_t verify){
+#if defined(JIT_X86_64)
+	Jit *jit = NULL;
+	void *code;
+
+	code = mmap(NULL, JIT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (code == MAP_FAILED)
+		return NULL;
+	jit = (Jit*)calloc(1, sizeof(Jit));
+	if (!jit){
+		munmap(code, JIT_CODE_SIZE);
+		return NULL;
+	}
+	jit->code = (uint8_t*)code;
+	jit->threshold = JIT_THRESHOLD;
+	jit->verify = verify;
+	if (verify){
+		jit->snapshot = (uint8_t*)malloc(JIT_SNAPSHOT_SIZE);
+		if (!jit->snapshot){
+			jit_Free(jit);
+			return NULL;
+		}
+	}
+	return jit;
+#else
+	return NULL;
+#endif
+}
+
+void jit_Free(Jit *pJit){
+#if defined(JIT_X86_64)
+	munmap(pJit->code, JIT_CODE_SIZE);
+#endif
+	free(pJit->snapshot);
+	free(pJit);
+	return;
+}
+
+#if defined(JIT_X86_64)
+
+// Cpu field offsets used by the generated code
+#define JIT_PC (offsetof(Cpu, PC))
+#define JIT_CLOCK (offsetof(Cpu, clock_cycle))
+#define JIT_HALT (offsetof(Cpu, halt))
+#define JIT_STOP (offsetof(Cpu, stop))
+
+// 8 bit registers in opcode order B, C, D, E, H, L, F, A
+static const uint32_t jit_reg[REG_BYTE] = {
+	offsetof(Cpu, B), offsetof(Cpu, C), offsetof(Cpu, D), offsetof(Cpu, E),
+	offsetof(Cpu, H), offsetof(Cpu, L), offsetof(Cpu, F), offsetof(Cpu, A)
+};
+// 16 bit registers in opcode order BC, DE, HL, SP
+static const uint32_t jit_dreg[4] = {
+	offsetof(Cpu, BC), offsetof(Cpu, DE), offsetof(Cpu, HL), offsetof(Cpu, SP)
+};
+
+// Code emitter
+typedef struct{
+	uint8_t *p;
+}Jit_Emitter;
+
+static void jit_Byte(Jit_Emitter *e, uint8_t b){
+	*e->p++ = b;
+	return;
+}
+
+static void jit_Bytes(Jit_Emitter *e, const uint8_t *b, uint8_t size){
+	memcpy(e->p, b, size);
+	e->p += size;
+	return;
+}
+
+static void jit_Imm16(Jit_Emitter *e, uint16_t v){
+	memcpy(e->p, &v, 2);
+	e->p += 2;
+	return;
+}
+
+static void jit_Imm32(Jit_Emitter *e, uint32_t v){
+	memcpy(e->p, &v, 4);
+	e->p += 4;
+	return;
+}
+
+static void jit_Imm64(Jit_Emitter *e, uint64_t v){
+	memcpy(e->p, &v, 8);
+	e->p += 8;
+	return;
+}
+
+// push rbx; push r12; sub rsp, 8; mov rbx, rdi; mov r12, &stale
+static void jit_Prologue(Jit_Emitter *e, const uint8_t *stale){
+	static const uint8_t code[] = {0x53, 0x41, 0x54, 0x48, 0x83, 0xEC, 0x08, 0x48, 0x89, 0xFB, 0x49, 0xBC};
+	jit_Bytes(e, code, sizeof(code));
+	jit_Imm64(e, (uintptr_t)stale);
+	return;
+}
+
+// add rsp, 8; pop r12; pop rbx; ret
+static void jit_Epilogue(Jit_Emitter *e){
+	static const uint8_t code[] = {0x48, 0x83, 0xC4, 0x08, 0x41, 0x5C, 0x5B, 0xC3};
+	jit_Bytes(e, code, sizeof(code));
+	return;
+}
+
+// add word [rbx + PC], offset
+static void jit_AddPC(Jit_Emitter *e, uint16_t offset){
+	if (!offset)
+		return;
+	jit_Byte(e, 0x66); jit_Byte(e, 0x81); jit_Byte(e, 0x83);
+	jit_Imm32(e, JIT_PC);
+	jit_Imm16(e, offset);
+	return;
+}
+
+// add qword [rbx + clock_cycle], cycles
+static void jit_AddClock(Jit_Emitter *e, uint32_t cycles){
+	if (!cycles)
+		return;
+	jit_Byte(e, 0x48); jit_Byte(e, 0x81); jit_Byte(e, 0x83);
+	jit_Imm32(e, JIT_CLOCK);
+	jit_Imm32(e, cycles);
+	return;
+}
+
+// Handler call: mov rdi, rbx; mov esi, opcode; mov edx, operand; mov rax, handler; call rax
+static void jit_Call(Jit_Emitter *e, Cpu_Handler handler, uint8_t opcode, uint16_t operand){
+	jit_Byte(e, 0x48); jit_Byte(e, 0x89); jit_Byte(e, 0xDF);
+	jit_Byte(e, 0xBE); jit_Imm32(e, opcode);
+	jit_Byte(e, 0xBA); jit_Imm32(e, operand);
+	jit_Byte(e, 0x48); jit_Byte(e, 0xB8); jit_Imm64(e, (uintptr_t)handler);
+	jit_Byte(e, 0xFF); jit_Byte(e, 0xD0);
+	return;
+}
+
+// Register only instructions emitted inline, returns 0 if the opcode needs its handler
+static uint8_t jit_Native(Jit_Emitter *e, uint16_t idx, uint16_t operand){
+	uint8_t r1 = (idx & 0x38) >> 3;
+	uint8_t r2 = idx & 0x07;
+
+	if (idx == 0x00) // NOP
+		return 1;
+	if (idx >= 0x40 && idx < 0x80 && idx != 0x76 && r1 != 6 && r2 != 6){ // LD r, r'
+		jit_Byte(e, 0x8A); jit_Byte(e, 0x83); jit_Imm32(e, jit_reg[r2]); // mov al, [rbx + r2]
+		jit_Byte(e, 0x88); jit_Byte(e, 0x83); jit_Imm32(e, jit_reg[r1]); // mov [rbx + r1], al
+		return 1;
+	}
+	if (idx < 0x40 && (idx & 0x07) == 0x06 && r1 != 6){ // LD r, n
+		jit_Byte(e, 0xC6); jit_Byte(e, 0x83); jit_Imm32(e, jit_reg[r1]); jit_Byte(e, operand);
+		return 1;
+	}
+	if (idx < 0x40 && (idx & 0x0F) == 0x01){ // LD rr, nn
+		jit_Byte(e, 0x66); jit_Byte(e, 0xC7); jit_Byte(e, 0x83); jit_Imm32(e, jit_dreg[idx >> 4]); jit_Imm16(e, operand);
+		return 1;
+	}
+	if (idx < 0x40 && ((idx & 0x0F) == 0x03 || (idx & 0x0F) == 0x0B)){ // INC rr, DEC rr
+		jit_Byte(e, 0x66); jit_Byte(e, 0xFF); jit_Byte(e, (idx & 0x08) ? 0x8B : 0x83); jit_Imm32(e, jit_dreg[idx >> 4]);
+		return 1;
+	}
+	return 0;
+}
+
+uint8_t jit_Compile(Jit *pJit, Cpu *pCpu, Block *pBlock){
+	Jit_Emitter e;
+	const Cpu_Opcode *op;
+	const Block_Op *bop;
+	uint16_t pc = 0; // offset from block start, PC is only written on exit
+	uint32_t pending = 0; // cycles not yet added to clock_cycle
+	uint8_t i, last;
+	uint32_t j;
+	uint8_t *skip, *skip_halt, *skip_stop;
+
+	// Code buffer full, drop every compiled block
+	if (pJit->used + JIT_BLOCK_MAX > JIT_CODE_SIZE){
+		for (j = 0; j < BLOCK_CACHE_SIZE; j++)
+			pCpu->blocks->blocks[j].native = NULL;
+		pJit->used = 0;
+		pJit->resets++;
+	}
+
+	e.p = pJit->code + pJit->used;
+	jit_Prologue(&e, &pCpu->blocks->stale);
+	for (i = 0; i < pBlock->count; i++){
+		bop = &pBlock->ops[i];
+		op = cpu_GetOpcode(bop->idx);
+		last = (i == pBlock->count - 1) && op->block_end;
+
+		if (!last && jit_Native(&e, bop->idx, bop->operand)){
+			pending += op->clock_cycles;
+			pc += op->size;
+			continue;
+		}
+
+		// Memory access may read the clock (IO), bring it up to date
+		if (op->memory){
+			jit_AddClock(&e, pending);
+			pending = 0;
+		}
+		if (last){ // control flow reads PC
+			jit_AddPC(&e, pc);
+			pc = 0;
+		}
+		jit_Call(&e, op->handler, bop->idx & 0xFF, bop->operand);
+		pending += op->clock_cycles;
+		pc += op->size;
+
+		if (last){
+			// PC advances unless the handler jumped or the Cpu halted/stopped
+			jit_Byte(&e, 0x84); jit_Byte(&e, 0xC0); // test al, al
+			jit_Byte(&e, 0x75); skip = e.p; jit_Byte(&e, 0x00); // jnz
+			jit_Byte(&e, 0x80); jit_Byte(&e, 0xBB); jit_Imm32(&e, JIT_HALT); jit_Byte(&e, 0x00); // cmp byte [rbx + halt], 0
+			jit_Byte(&e, 0x75); skip_halt = e.p; jit_Byte(&e, 0x00); // jne
+			jit_Byte(&e, 0x80); jit_Byte(&e, 0xBB); jit_Imm32(&e, JIT_STOP); jit_Byte(&e, 0x00); // cmp byte [rbx + stop], 0
+			jit_Byte(&e, 0x75); skip_stop = e.p; jit_Byte(&e, 0x00); // jne
+			jit_AddPC(&e, op->size);
+			*skip = (uint8_t)(e.p - skip - 1);
+			*skip_halt = (uint8_t)(e.p - skip_halt - 1);
+			*skip_stop = (uint8_t)(e.p - skip_stop - 1);
+			jit_AddClock(&e, pending);
+			jit_Epilogue(&e);
+			break;
+		}
+
+		if (op->memory && i < pBlock->count - 1){
+			// Leave block on stale code or memory map change
+			jit_Byte(&e, 0x41); jit_Byte(&e, 0x80); jit_Byte(&e, 0x3C); jit_Byte(&e, 0x24); jit_Byte(&e, 0x00); // cmp byte [r12], 0
+			jit_Byte(&e, 0x74); skip = e.p; jit_Byte(&e, 0x00); // je
+			jit_AddPC(&e, pc);
+			jit_AddClock(&e, pending);
+			jit_Epilogue(&e);
+			*skip = (uint8_t)(e.p - skip - 1);
+		}
+	}
+	if (i == pBlock->count){ // block ended without control flow
+		jit_AddPC(&e, pc);
+		jit_AddClock(&e, pending);
+		jit_Epilogue(&e);
+	}
+
+	pBlock->native = pJit->code + pJit->used;
+	pJit->used += (uint32_t)(e.p - (pJit->code + pJit->used));
+	pJit->used = (pJit->used + 15) & ~15u;
+	pJit->compiled++;
+	return 1;
+}
+
+#else
+
+uint8_t jit_Compile(Jit *pJit, Cpu *pCpu, Block *pBlock){
+	return 0;
+}
+
+#endif
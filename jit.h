@@ -0,0 +1,72 @@
+#ifndef _JIT_H
+#define _JIT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cpu.h"
+#include "ram.h"
+#include "block.h"
+
+/*
+
+	x86-64 dynamic recompiler
+
+	Hot decoded blocks (see block.h) are translated to native code. Register
+	only instructions (NOP, LD r,r', LD r,n, LD rr,nn, INC/DEC rr) are emitted
+	inline, everything else calls the interpreter opcode handler.
+
+	clock_cycle is updated in bulk: pending cycles are only added before an
+	instruction accessing memory and at the block exit. After a memory write
+	the block cache stale flag is checked, so self-modifying code leaves the
+	block with PC and clock_cycle of the next instruction.
+
+	The Cpu interpreter stays the reference, in verify mode every native
+	block also runs in the interpreter from the same state and both results
+	are compared (cpu.c, cpu_JitVerify). RAM, IO ports and cartridge RAM
+	banks are restored between both runs and host objects (trace,
+	profiler, serial capture, save file) only see the native one, a
+	verified run gives the same results as a plain one. tools/jit_check.c
+	runs random programs that way.
+
+	Only built on x86-64 unix, jit_Init returns NULL elsewhere.
+
+*/
+
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+	#define JIT_X86_64
+#endif
+
+#define JIT_CODE_SIZE (0x100000) // executable buffer, reset when full
+// Worst case code sizes, the emitter does not check for the end of the buffer
+#define JIT_PROLOGUE_MAX (20)
+#define JIT_OP_MAX (71) // memory access: clock, call, stale check, then PC, clock and epilogue on the exit path
+#define JIT_EXIT_MAX (28) // PC, clock and epilogue, control flow as last op takes at most JIT_OP_MAX + JIT_EXIT_MAX
+#define JIT_BLOCK_MAX (JIT_PROLOGUE_MAX + BLOCK_MAX_OPS * JIT_OP_MAX + JIT_EXIT_MAX + 15) // 15 alignment bytes
+#define JIT_SNAPSHOT_SIZE (MEM_TOTAL_SIZE + RAM_SIZE_MAX) // verify mode: mapped pages, then every cartridge RAM bank
+#define JIT_THRESHOLD (16) // interpreted runs before a block is compiled
+
+// Compiled block, called with the Cpu
+typedef void (*Jit_Block)(Cpu *pCpu);
+
+// Jit structure
+typedef struct Jit{
+	uint8_t *code; // executable buffer
+	uint32_t used; // bytes used in code
+	uint8_t threshold; // interpreted runs before a block is compiled
+	uint8_t verify; // check every native block against the interpreter
+	uint8_t *snapshot; // verify mode memory snapshot, JIT_SNAPSHOT_SIZE bytes
+	uint64_t compiled; // number of compiled blocks
+	uint64_t resets; // number of code buffer resets
+	uint64_t verified; // number of native blocks checked
+	uint64_t mismatches; // number of native blocks differing from the interpreter
+}Jit;
+
+// Initialize and return a Jit, NULL if the host is not supported
+Jit* jit_Init(uint8_t verify);
+// Free a Jit
+void jit_Free(Jit *pJit);
+// Compile a decoded block, sets pBlock->native, returns 0 on failure
+uint8_t jit_Compile(Jit *pJit, Cpu *pCpu, Block *pBlock);
+
+#endif
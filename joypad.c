@@ -0,0 +1,29 @@
+#include "joypad.h"
+
+void joypad_Update(Cpu *pCpu){
+	uint8_t lines = 0x0F, old = pCpu->sfr->P1;
+
+	if (!pCpu->sfr->P1_bits.P14)
+		lines &= ~pCpu->buttons & 0x0F;
+	if (!pCpu->sfr->P1_bits.P15)
+		lines &= ~pCpu->buttons >> 4;
+	pCpu->sfr->P1 = 0xC0 | (old & 0x30) | lines;
+	// Interrupt on a high to low transition of an input line
+	if (old & ~lines & 0x0F){
+		pCpu->sfr->IF_bits.falling_edge_P1 = 1;
+		cpu_UpdateInterrupt(pCpu);
+	}
+	return;
+}
+
+void joypad_Write(Cpu *pCpu, uint8_t data){
+	pCpu->sfr->P1 = (data & 0x30) | (pCpu->sfr->P1 & 0x0F);
+	joypad_Update(pCpu);
+	return;
+}
+
+void joypad_Set(Cpu *pCpu, uint8_t buttons){
+	pCpu->buttons = buttons;
+	joypad_Update(pCpu);
+	return;
+}
@@ -0,0 +1,34 @@
+#ifndef _JOYPAD_H
+#define _JOYPAD_H
+
+#include "cpu.h"
+
+/*
+
+	Joypad
+
+	The front end sets the pressed buttons, P1 reads them through the
+	select lines: P14 low reads the directions, P15 low reads the buttons,
+	a pressed key reads 0. P1 is refreshed when the buttons or the select
+	lines change, a line going low requests the joypad interrupt.
+
+*/
+
+// Buttons, one bit each in Cpu.buttons
+#define JOYPAD_RIGHT (0x01)
+#define JOYPAD_LEFT (0x02)
+#define JOYPAD_UP (0x04)
+#define JOYPAD_DOWN (0x08)
+#define JOYPAD_A (0x10)
+#define JOYPAD_B (0x20)
+#define JOYPAD_SELECT (0x40)
+#define JOYPAD_START (0x80)
+
+// Refresh P1 input lines from the pressed buttons
+void joypad_Update(Cpu *pCpu);
+// Write to P1, only the select lines are writable
+void joypad_Write(Cpu *pCpu, uint8_t data);
+// Set pressed buttons (JOYPAD_* mask)
+void joypad_Set(Cpu *pCpu, uint8_t buttons);
+
+#endif
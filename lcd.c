@@ -1 +1,74 @@
-#include "lcd.h"
\ No newline at end of file
+#include "lcd.h"
+
+// Set STAT mode, request LCDC interrupt when the mode is selected in STAT
+static void lcd_SetMode(Cpu *pCpu, uint8_t mode){
+	union Special_Register *sfr = pCpu->sfr;
+	sfr->STAT_bits.mode_flag = mode;
+	if ((mode == LCD_MODE_HBLANK && sfr->STAT_bits.mode_00)
+		|| (mode == LCD_MODE_VBLANK && sfr->STAT_bits.mode_01)
+		|| (mode == LCD_MODE_OAM && sfr->STAT_bits.mode_10))
+		sfr->IF_bits.lcdc = 1;
+	return;
+}
+
+// Set LY, compare with LYC
+static void lcd_SetLine(Cpu *pCpu, uint8_t line){
+	union Special_Register *sfr = pCpu->sfr;
+	sfr->LY = line;
+	sfr->STAT_bits.coincidence_flag = line == sfr->LYC;
+	if (sfr->STAT_bits.coincidence_flag && sfr->STAT_bits.coincidence_sel)
+		sfr->IF_bits.lcdc = 1;
+	return;
+}
+
+void lcd_Start(Cpu *pCpu){
+	lcd_SetLine(pCpu, 0);
+	lcd_SetMode(pCpu, LCD_MODE_OAM);
+	sched_Add(&pCpu->sched, SCHED_EVENT_LCD, pCpu->clock_cycle + LCD_MODE_OAM_CYCLES);
+	return;
+}
+
+void lcd_Stop(Cpu *pCpu){
+	sched_Remove(&pCpu->sched, SCHED_EVENT_LCD);
+	pCpu->sfr->LY = 0;
+	pCpu->sfr->STAT_bits.mode_flag = LCD_MODE_HBLANK;
+	return;
+}
+
+void lcd_Event(Cpu *pCpu, uint64_t deadline){
+	uint8_t line = pCpu->sfr->LY;
+
+	switch (pCpu->sfr->STAT_bits.mode_flag){
+		case LCD_MODE_OAM:
+			lcd_SetMode(pCpu, LCD_MODE_TRANSFER);
+			deadline += LCD_MODE_TRANSFER_CYCLES;
+			break;
+		case LCD_MODE_TRANSFER:
+			lcd_SetMode(pCpu, LCD_MODE_HBLANK);
+			deadline += LCD_MODE_HBLANK_CYCLES;
+			break;
+		case LCD_MODE_HBLANK: // end of visible line
+			lcd_SetLine(pCpu, line + 1);
+			if (line + 1 == LCD_HEIGHT){
+				lcd_SetMode(pCpu, LCD_MODE_VBLANK);
+				pCpu->sfr->IF_bits.v_blank = 1;
+				deadline += LCD_LINE_CYCLES;
+			}else{
+				lcd_SetMode(pCpu, LCD_MODE_OAM);
+				deadline += LCD_MODE_OAM_CYCLES;
+			}
+			break;
+		default: // VBlank lines, back to line 0 after the last one
+			if (line + 1 < LCD_LINES){
+				lcd_SetLine(pCpu, line + 1);
+				deadline += LCD_LINE_CYCLES;
+			}else{
+				lcd_SetLine(pCpu, 0);
+				lcd_SetMode(pCpu, LCD_MODE_OAM);
+				deadline += LCD_MODE_OAM_CYCLES;
+			}
+			break;
+	}
+	sched_Add(&pCpu->sched, SCHED_EVENT_LCD, deadline);
+	return;
+}
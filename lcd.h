@@ -1,6 +1,8 @@
 #ifndef _LCD_H
 #define _LCD_H
 
+#include "cpu.h"
+
 /*
 
 	DMG LCD screen:
@@ -23,5 +25,33 @@
 #define LCD_WIDTH (160)
 #define LCD_HEIGHT (144)
 
+#define LCD_LINE_CYCLES (456) // clock cycles per scanline
+#define LCD_LINES (154) // 144 visible + 10 VBlank lines
+#define LCD_FRAME_CYCLES (LCD_LINE_CYCLES * LCD_LINES) // 70224 clock cycles per frame
+
+// STAT mode flag values
+#define LCD_MODE_HBLANK (0)
+#define LCD_MODE_VBLANK (1)
+#define LCD_MODE_OAM (2)
+#define LCD_MODE_TRANSFER (3)
+
+// Clock cycles spent in each mode of a visible line
+#define LCD_MODE_OAM_CYCLES (80)
+#define LCD_MODE_TRANSFER_CYCLES (172)
+#define LCD_MODE_HBLANK_CYCLES (LCD_LINE_CYCLES - LCD_MODE_OAM_CYCLES - LCD_MODE_TRANSFER_CYCLES)
+
+/*
+	LCD timing runs on SCHED_EVENT_LCD, one event per mode change of a
+	visible line and one per VBlank line. LY, STAT and the LCDC/VBlank
+	interrupt flags are updated when the event fires.
+*/
+
+// Start LCD timing at line 0, called when LCDC operation is switched on
+void lcd_Start(Cpu *pCpu);
+// Stop LCD timing, called when LCDC operation is switched off
+void lcd_Stop(Cpu *pCpu);
+// SCHED_EVENT_LCD handler
+void lcd_Event(Cpu *pCpu, uint64_t deadline);
+
 
-#endif
\ No newline at end of file
+#endif
@@ -1,39 +1,59 @@
 #include <stdint.h>
 #include <stdio.h>
-
-#include <SDL2/SDL.h>
+#include <string.h>
 
 #include "vm.h"
+#include "cli.h"
+#include "frontend.h"
+
+// Free the VM, the window and what the options attached, returns ret
+static int main_Exit(VM *pVm, Frontend *pFront, Cli *pCli, int ret){
+	vm_Quit(pVm);
+	if (pFront)
+		frontend_Quit(pFront);
+	cli_Free(pCli);
+	return ret;
+}
 
 int main(int argc, char *argv[]){
-	uint8_t test_logo[48] = { // Nintendo Logo
-		0xce, 0xed, 0x66, 0x66, 0xcc, 0x0d, 0x00, 0x0b,
-		0x03, 0x73, 0x00, 0x83, 0x00, 0x0c, 0x00, 0x0d,
-		0x00, 0x08, 0x11, 0x1f, 0x88, 0x89, 0x00, 0x0e,
-		0xdc, 0xcc, 0x6e, 0xe6, 0xdd, 0xdd, 0xd9, 0x99,
-		0xbb, 0xbb, 0x67, 0x63, 0x6e, 0x0e, 0xec, 0xcc,
-		0xdd, 0xdc, 0x99, 0x9f, 0xbb, 0xb9, 0x33, 0x3e
-	};
-
 	VM *vm = NULL;
-	vm = vm_Init();
+	Frontend *front = NULL;
+	Cli cli;
+
+	vm = vm_Init(cli_VmFlags(argc, argv));
 	if (!vm)
 		return -1;
+	if (cli_Parse(&cli, vm, argc, argv) != 0){
+		cli_Usage(argv[0]);
+		return main_Exit(vm, NULL, &cli, -1);
+	}
 
-	if (vm_LoadBios(vm, "bios/bios.gb") != 0){
+	front = frontend_Init();
+	if (!front){
+		printf("Could not open a window, use the headless runner without a display\n");
+		return main_Exit(vm, NULL, &cli, -1);
+	}
+
+	if (vm_LoadBios(vm, cli.bios_path) != 0){
 		// TODO: Setup cpu and memory as if the bios just executed
-		return -1;
+		return main_Exit(vm, front, &cli, -1);
 	}
 
-	// Write logo to ROM at correct location for the bios to check
-	if (mem_WriteMulti(vm->ROM, 0x104, test_logo, 48) == 0x100)
-		return -1;
+	// Cartridge, or the logo alone at the correct location for the bios to check
+	if (cli_LoadRom(&cli, vm) != 0)
+		return main_Exit(vm, front, &cli, -1);
+	if (cli_LoadState(&cli, vm) != 0)
+		return main_Exit(vm, front, &cli, -1);
+	front->rewind = cli.rewind;
 
 	// Run bios
-	vm_Run(vm);
+	if (cli.frames)
+		vm_Run(vm, cli.frames);
+	else
+		frontend_Run(front, vm);
 
 	// Exit
 	DEBUG_PRINTF("\nFree stuff & exit\n");
-	vm_Quit(vm);
-	return 0;
+	cli_SaveState(&cli, vm);
+	return main_Exit(vm, front, &cli, 0);
 }
@@ -0,0 +1,176 @@
+#include "mbc.h"
+#include "sram.h"
+
+// Cartridge RAM size of each header code, 2KB chips take a whole bank
+static const uint32_t mbc_ram_sizes[] = {0, RAM_BANK_SIZE, RAM_BANK_SIZE, 4 * RAM_BANK_SIZE, 16 * RAM_BANK_SIZE, 8 * RAM_BANK_SIZE};
+
+int8_t mbc_Header(const uint8_t *pRom, uint8_t *pMbc, uint32_t *pRamSize){
+	uint8_t code = pRom[ROM_HEADER_RAM_SIZE];
+
+	switch (pRom[ROM_HEADER_TYPE]){
+		case 0x00: // ROM only
+		case 0x08: // ROM + RAM
+		case 0x09: // ROM + RAM + battery
+			*pMbc = MBC_NONE;
+			break;
+		case 0x01:
+		case 0x02:
+		case 0x03:
+			*pMbc = MBC_1;
+			break;
+		case 0x0F: // timer + battery
+		case 0x10: // timer + RAM + battery
+		case 0x11:
+		case 0x12:
+		case 0x13:
+			*pMbc = MBC_3;
+			break;
+		case 0x19:
+		case 0x1A:
+		case 0x1B:
+		case 0x1C: // rumble
+		case 0x1D:
+		case 0x1E:
+			*pMbc = MBC_5;
+			break;
+		default:
+			return -1;
+	}
+	*pRamSize = code < sizeof(mbc_ram_sizes) / sizeof(mbc_ram_sizes[0]) ? mbc_ram_sizes[code] : 0;
+	return 0;
+}
+
+// Point the ROM and RAM memory maps at the banks selected by the registers
+static void mbc_SelectBanks(Cpu *pCpu){
+	Memory *rom0 = &pCpu->map[MAP_ROM_BANK_0].mem;
+	Memory *rom = &pCpu->map[MAP_ROM_BANK_SWITCH].mem;
+	Memory *ram = &pCpu->map[MAP_RAM_BANK_SWITCH].mem;
+	uint32_t rom0_bank = 0, rom_bank = pCpu->mbc_rom_bank, ram_bank = pCpu->mbc_ram_bank;
+
+	// MBC1 second register, upper ROM bank bits, also RAM bank and ROM bank 0 area in mode 1
+	if (pCpu->mbc == MBC_1){
+		rom_bank |= ram_bank << 5;
+		if (pCpu->mbc_mode)
+			rom0_bank = ram_bank << 5;
+		else
+			ram_bank = 0;
+	}
+	mem_SetStartIndex(rom0, (rom0_bank % rom0->banks) * rom0->bank_size);
+	mem_SetStartIndex(rom, (rom_bank % rom->banks) * rom->bank_size);
+	if (ram->banks)
+		mem_SetStartIndex(ram, (ram_bank % ram->banks) * ram->bank_size);
+	return;
+}
+
+void mbc_Init(Cpu *pCpu, uint8_t mbc){
+	pCpu->mbc = mbc;
+	pCpu->mbc_ram_enable = 0;
+	pCpu->mbc_mode = 0;
+	pCpu->mbc_rom_bank = 1;
+	pCpu->mbc_ram_bank = 0;
+	pCpu->mbc_latch = 0xFF;
+	memset(pCpu->rtc, 0, sizeof(pCpu->rtc));
+	memset(pCpu->rtc_latched, 0, sizeof(pCpu->rtc_latched));
+	pCpu->rtc_base = pCpu->clock_cycle;
+	mbc_SelectBanks(pCpu);
+	return;
+}
+
+// Advance the MBC3 clock registers to clock_cycle
+static void mbc_RtcUpdate(Cpu *pCpu){
+	uint8_t *rtc = pCpu->rtc;
+	uint64_t seconds, days;
+
+	if (rtc[MBC_RTC_DH] & MBC_RTC_HALT){
+		pCpu->rtc_base = pCpu->clock_cycle;
+		return;
+	}
+	seconds = (pCpu->clock_cycle - pCpu->rtc_base) / CPU_CLOCK_HZ;
+	if (!seconds)
+		return;
+	pCpu->rtc_base += seconds * CPU_CLOCK_HZ;
+
+	days = rtc[MBC_RTC_DL] | (rtc[MBC_RTC_DH] & MBC_RTC_DAY_HIGH) << 8;
+	seconds += rtc[MBC_RTC_S] + 60 * (rtc[MBC_RTC_M] + 60 * (rtc[MBC_RTC_H] + 24 * days));
+	days = seconds / 86400;
+	rtc[MBC_RTC_S] = seconds % 60;
+	rtc[MBC_RTC_M] = seconds / 60 % 60;
+	rtc[MBC_RTC_H] = seconds / 3600 % 24;
+	rtc[MBC_RTC_DL] = days & 0xFF;
+	rtc[MBC_RTC_DH] = (rtc[MBC_RTC_DH] & MBC_RTC_CARRY) | (days >> 8 & MBC_RTC_DAY_HIGH);
+	if (days > 0x1FF)
+		rtc[MBC_RTC_DH] |= MBC_RTC_CARRY;
+	return;
+}
+
+void mbc_FillPage(Cpu *pCpu){
+	uint8_t value = 0xFF;
+
+	if (pCpu->mbc == MBC_3 && pCpu->mbc_ram_enable && pCpu->mbc_ram_bank >= MBC_RTC_SELECT
+		&& pCpu->mbc_ram_bank < MBC_RTC_SELECT + MBC_RTC_REGS)
+		value = pCpu->rtc_latched[pCpu->mbc_ram_bank - MBC_RTC_SELECT];
+	memset(pCpu->mbc_page, value, MEM_PAGE_SIZE);
+	return;
+}
+
+void mbc_Write(Cpu *pCpu, uint8_t data){
+	uint16_t rom_bank = pCpu->mbc_rom_bank;
+	uint8_t ram_enable = pCpu->mbc_ram_enable, ram_bank = pCpu->mbc_ram_bank, mode = pCpu->mbc_mode;
+	uint8_t area = pCpu->address_bus >> 13; // 8KB register areas
+
+	if (pCpu->mbc == MBC_NONE)
+		return;
+	if (area == 0){
+		pCpu->mbc_ram_enable = (data & 0x0F) == 0x0A;
+		// Games disable RAM once a save is written
+		if (ram_enable && !pCpu->mbc_ram_enable && pCpu->sram)
+			sram_Flush(pCpu->sram);
+	}else if (area == 1){
+		if (pCpu->mbc == MBC_1)
+			pCpu->mbc_rom_bank = (data & 0x1F) ? (data & 0x1F) : 1;
+		else if (pCpu->mbc == MBC_3)
+			pCpu->mbc_rom_bank = (data & 0x7F) ? (data & 0x7F) : 1;
+		else if (pCpu->address_bus < 0x3000) // MBC5, bank 0 can be selected
+			pCpu->mbc_rom_bank = (pCpu->mbc_rom_bank & 0x100) | data;
+		else
+			pCpu->mbc_rom_bank = (pCpu->mbc_rom_bank & 0xFF) | (data & 0x01) << 8;
+	}else if (area == 2){
+		pCpu->mbc_ram_bank = data & (pCpu->mbc == MBC_1 ? 0x03 : 0x0F);
+	}else if (pCpu->mbc == MBC_1){
+		pCpu->mbc_mode = data & 0x01;
+	}else if (pCpu->mbc == MBC_3){
+		if (pCpu->mbc_latch == 0x00 && data == 0x01){
+			mbc_RtcUpdate(pCpu);
+			memcpy(pCpu->rtc_latched, pCpu->rtc, MBC_RTC_REGS);
+			if (!mbc_RamMapped(pCpu))
+				mbc_FillPage(pCpu);
+		}
+		pCpu->mbc_latch = data;
+	}
+
+	// Same banks selected, the page table is unchanged
+	if (pCpu->mbc_rom_bank == rom_bank && pCpu->mbc_ram_enable == ram_enable
+		&& pCpu->mbc_ram_bank == ram_bank && pCpu->mbc_mode == mode)
+		return;
+	mbc_SelectBanks(pCpu);
+	if (pCpu->mbc == MBC_1 && (area == 2 || area == 3))
+		cpu_UpdatePageTable(pCpu); // ROM bank 0 area may have moved
+	else if (area == 1)
+		cpu_UpdateRomBankPages(pCpu);
+	else
+		cpu_UpdateRamBankPages(pCpu);
+	return;
+}
+
+void mbc_WriteRam(Cpu *pCpu, uint8_t data){
+	static const uint8_t masks[MBC_RTC_REGS] = {0x3F, 0x3F, 0x1F, 0xFF, 0xC1};
+	uint8_t reg = pCpu->mbc_ram_bank - MBC_RTC_SELECT;
+
+	if (pCpu->mbc != MBC_3 || !pCpu->mbc_ram_enable || pCpu->mbc_ram_bank < MBC_RTC_SELECT || reg >= MBC_RTC_REGS)
+		return;
+	mbc_RtcUpdate(pCpu);
+	pCpu->rtc[reg] = data & masks[reg];
+	if (reg == MBC_RTC_S)
+		pCpu->rtc_base = pCpu->clock_cycle; // restarts the second
+	return;
+}
@@ -0,0 +1,68 @@
+#ifndef _MBC_H
+#define _MBC_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "cpu.h"
+#include "rom.h"
+#include "ram.h"
+
+/*
+
+	Cartridge mappers
+
+	MBC1, MBC3 and MBC5 bank registers are written at $0000 - $7FFF.
+	A bank switch moves the start index of the ROM or RAM memory map and
+	points the 64 (ROM) or 32 (RAM) page table entries of its window at
+	the new bank, no data is copied and the cost does not depend on the
+	cartridge size. Writing the bank already selected changes nothing.
+
+	Cartridge RAM is mapped writable while enabled. Disabled or missing
+	RAM and the MBC3 clock registers read from mbc_page, 0xFF or the
+	latched clock register, writes to them go through cpu_WriteControl.
+
+	The MBC3 clock runs on emulated time (clock_cycle), runs of the same
+	input stay deterministic.
+
+*/
+
+// Mappers
+#define MBC_NONE (0)
+#define MBC_1 (1)
+#define MBC_3 (3)
+#define MBC_5 (5)
+
+// MBC3 clock registers, selected with RAM bank numbers from MBC_RTC_SELECT
+#define MBC_RTC_SELECT (0x08)
+#define MBC_RTC_S (0)
+#define MBC_RTC_M (1)
+#define MBC_RTC_H (2)
+#define MBC_RTC_DL (3)
+#define MBC_RTC_DH (4) // day bit 8, halt, day carry
+#define MBC_RTC_REGS (5)
+#define MBC_RTC_DAY_HIGH (0x01)
+#define MBC_RTC_HALT (0x40)
+#define MBC_RTC_CARRY (0x80)
+
+// Mapper and cartridge RAM size from a cartridge header, returns -1 for an unsupported mapper
+int8_t mbc_Header(const uint8_t *pRom, uint8_t *pMbc, uint32_t *pRamSize);
+// Select mapper, reset its registers and point the memory maps at the first banks
+void mbc_Init(Cpu *pCpu, uint8_t mbc);
+// Write to a mapper register at address_bus, $0000 - $7FFF
+void mbc_Write(Cpu *pCpu, uint8_t data);
+// Write at address_bus to $A000 - $BFFF without a RAM bank mapped: MBC3 clock register or nothing
+void mbc_WriteRam(Cpu *pCpu, uint8_t data);
+// Fill mbc_page with what $A000 - $BFFF reads without a RAM bank mapped
+void mbc_FillPage(Cpu *pCpu);
+
+// Returns 1 if a cartridge RAM bank is mapped at $A000 - $BFFF
+static inline uint8_t mbc_RamMapped(const Cpu *pCpu){
+	if (!pCpu->map[MAP_RAM_BANK_SWITCH].mem.banks)
+		return 0;
+	if (pCpu->mbc == MBC_NONE)
+		return 1;
+	return pCpu->mbc_ram_enable && !(pCpu->mbc == MBC_3 && pCpu->mbc_ram_bank >= MBC_RTC_SELECT);
+}
+
+#endif
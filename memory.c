@@ -2,17 +2,28 @@
 
 Memory *mem_Init(uint32_t size, uint32_t banks, uint32_t bank_size){
 	Memory *mem = NULL;
+	uint8_t *data = NULL;
 
-	if ((size/banks == bank_size) && (size%banks == 0)){
-		mem = (Memory*)malloc(sizeof(Memory));
-		mem->size = size;
-		mem->banks = banks;
-		mem->bank_size = bank_size;
-		mem_SetStartIndex(mem, 0);
-		mem->data = (uint8_t*)malloc(sizeof(uint8_t) * size);
-		return mem;
+	mem = (Memory*)malloc(sizeof(Memory));
+	data = (uint8_t*)calloc(size, sizeof(uint8_t)); // zeroed, runs are reproducible
+	if (!mem || !data || mem_Setup(mem, data, size, banks, bank_size) != 0){
+		free(mem);
+		free(data);
+		return NULL;
 	}
-	return NULL;
+	return mem;
+}
+
+int8_t mem_Setup(Memory *pMem, uint8_t *data, uint32_t size, uint32_t banks, uint32_t bank_size){
+	// Empty memory (cartridge without RAM) has no bank
+	if (banks ? (size/banks != bank_size) || (size%banks != 0) : size != 0)
+		return -1;
+	pMem->data = data;
+	pMem->size = size;
+	pMem->banks = banks;
+	pMem->bank_size = bank_size;
+	mem_SetStartIndex(pMem, 0);
+	return 0;
 }
 
 void mem_Free(Memory *pMem){
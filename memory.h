@@ -16,7 +16,9 @@ typedef struct{
 
 // Initialize and return a Memory structure
 Memory *mem_Init(uint32_t size, uint32_t banks, uint32_t bank_size);
-// Free a memory
+// Describe memory held by the caller (VM arena), returns 0 on success
+int8_t mem_Setup(Memory *pMem, uint8_t *data, uint32_t size, uint32_t banks, uint32_t bank_size);
+// Free a memory from mem_Init
 void mem_Free(Memory *pMem);
 
 // Set start index of a memory
@@ -11,6 +11,10 @@
 
 #define MEM_ADDRESS_SPACES (10)
 
+// Page table granularity used by the Cpu for address decoding
+#define MEM_PAGE_SIZE (0x100)
+#define MEM_PAGES (MEM_TOTAL_SIZE / MEM_PAGE_SIZE)
+
 /*
 +---------------------+---------------+------+
 |         Map         | Address Range | Size |
@@ -78,6 +82,17 @@ enum{
 #define MEM_SPRITE_ATTRI_OFFSET (0xFE00)
 #define MEM_UNUSABLE_OFFSET (0xFEA0)
 #define MEM_IO_PORTS_OFFSET (0xFF00)
+#define MEM_P1_REG_OFFSET (0xFF00)
+#define MEM_SC_REG_OFFSET (0xFF02)
+#define MEM_DIV_REG_OFFSET (0xFF04)
+#define MEM_TIMA_REG_OFFSET (0xFF05)
+#define MEM_TMA_REG_OFFSET (0xFF06)
+#define MEM_TAC_REG_OFFSET (0xFF07)
+#define MEM_IF_REG_OFFSET (0xFF0F)
+#define MEM_LCDC_REG_OFFSET (0xFF40)
+#define MEM_STAT_REG_OFFSET (0xFF41)
+#define MEM_LY_REG_OFFSET (0xFF44)
+#define MEM_BIOS_REG_OFFSET (0xFF50)
 #define MEM_HRAM_OFFSET (0xFF80)
 #define MEM_IE_REG_OFFSET (0xFFFF)
 
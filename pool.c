@@ -0,0 +1,131 @@
+#include <unistd.h>
+
+#include "pool.h"
+
+// Worker thread argument
+typedef struct{
+	Pool *pool;
+	uint32_t id;
+}Pool_Worker;
+
+uint32_t pool_Cores(void){
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cores < 1)
+		return 1;
+	if (cores > POOL_MAX_THREADS)
+		return POOL_MAX_THREADS;
+	return cores;
+}
+
+// Take next index of own slice, returns 0 when empty
+static uint8_t pool_Take(Pool_Slice *pSlice, uint32_t *pIdx){
+	uint8_t found = 0;
+
+	pthread_mutex_lock(&pSlice->lock);
+	if (pSlice->next < pSlice->end){
+		*pIdx = pSlice->next++;
+		found = 1;
+	}
+	pthread_mutex_unlock(&pSlice->lock);
+	return found;
+}
+
+// Move back half of the largest other slice to worker id, returns 0 when no work is left
+static uint8_t pool_Steal(Pool *pPool, uint32_t id){
+	Pool_Slice *victim, *own = &pPool->slices[id];
+	uint32_t i, best = id, left, most = 0, half, start;
+
+	// Sizes only pick the victim, the steal is checked again under its lock
+	for (i = 0; i < pPool->threads; i++){
+		if (i == id)
+			continue;
+		pthread_mutex_lock(&pPool->slices[i].lock);
+		left = pPool->slices[i].end - pPool->slices[i].next;
+		pthread_mutex_unlock(&pPool->slices[i].lock);
+		if (left > most){
+			most = left;
+			best = i;
+		}
+	}
+	if (best == id)
+		return 0;
+
+	victim = &pPool->slices[best];
+	pthread_mutex_lock(&victim->lock);
+	if (victim->next >= victim->end){
+		pthread_mutex_unlock(&victim->lock);
+		return 1; // emptied meanwhile, look again
+	}
+	half = (victim->end - victim->next + 1) / 2;
+	victim->end -= half;
+	start = victim->end;
+	pthread_mutex_unlock(&victim->lock);
+	// One lock held at a time, the own slice is empty until set
+	pthread_mutex_lock(&own->lock);
+	own->next = start;
+	own->end = start + half;
+	pthread_mutex_unlock(&own->lock);
+
+	pthread_mutex_lock(&pPool->stats_lock);
+	pPool->steals++;
+	pthread_mutex_unlock(&pPool->stats_lock);
+	return 1;
+}
+
+static void* pool_Work(void *pArg){
+	Pool_Worker *worker = (Pool_Worker*)pArg;
+	Pool *pool = worker->pool;
+	uint32_t idx;
+
+	do{
+		while (pool_Take(&pool->slices[worker->id], &idx))
+			pool->task(pool->arg, idx);
+	}while (pool_Steal(pool, worker->id));
+	return NULL;
+}
+
+int8_t pool_Run(Pool_Task task, void *pArg, uint32_t count, uint32_t threads, uint32_t *pSteals){
+	Pool *pool = NULL;
+	Pool_Worker workers[POOL_MAX_THREADS];
+	pthread_t ids[POOL_MAX_THREADS];
+	uint32_t i, started;
+
+	if (!threads)
+		threads = pool_Cores();
+	if (threads > POOL_MAX_THREADS)
+		threads = POOL_MAX_THREADS;
+	if (threads > count)
+		threads = count ? count : 1;
+
+	pool = (Pool*)calloc(1, sizeof(Pool));
+	if (!pool)
+		return -1;
+	pool->task = task;
+	pool->arg = pArg;
+	pool->threads = threads;
+	pthread_mutex_init(&pool->stats_lock, NULL);
+	for (i = 0; i < threads; i++){
+		pthread_mutex_init(&pool->slices[i].lock, NULL);
+		pool->slices[i].next = (uint64_t)count * i / threads;
+		pool->slices[i].end = (uint64_t)count * (i + 1) / threads;
+		workers[i].pool = pool;
+		workers[i].id = i;
+	}
+
+	for (started = 1; started < threads; started++){
+		// Slices of workers not started are stolen by the others
+		if (pthread_create(&ids[started], NULL, pool_Work, &workers[started]) != 0)
+			break;
+	}
+	pool_Work(&workers[0]);
+	for (i = 1; i < started; i++)
+		pthread_join(ids[i], NULL);
+
+	if (pSteals)
+		*pSteals = pool->steals;
+	for (i = 0; i < threads; i++)
+		pthread_mutex_destroy(&pool->slices[i].lock);
+	pthread_mutex_destroy(&pool->stats_lock);
+	free(pool);
+	return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef _POOL_H
+#define _POOL_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/*
+
+	Work stealing thread pool
+
+	Runs a task on every index of [0; count), each worker starts with an
+	equal slice of the range and takes indices from its front. A worker
+	out of work steals the back half of the largest slice left, long jobs
+	at the end of one slice do not hold the others idle.
+
+	Slices are guarded by one mutex per worker, a worker never holds two
+	of them. The calling thread is worker 0.
+
+*/
+
+#define POOL_MAX_THREADS (256)
+
+// Task run on each index
+typedef void (*Pool_Task)(void *pArg, uint32_t idx);
+
+// Range of indices left to a worker
+typedef struct{
+	pthread_mutex_t lock;
+	uint32_t next; // next index to run
+	uint32_t end;
+}Pool_Slice;
+
+// Pool structure, lives for one pool_Run
+typedef struct{
+	Pool_Task task;
+	void *arg;
+	uint32_t threads;
+	Pool_Slice slices[POOL_MAX_THREADS];
+	uint32_t steals; // slices stolen
+	pthread_mutex_t stats_lock;
+}Pool;
+
+// Returns the number of online host cores
+uint32_t pool_Cores(void);
+// Run task on [0; count) with threads workers (0 uses every core), returns 0 on success,
+// pSteals (may be NULL) gets the number of slices stolen
+int8_t pool_Run(Pool_Task task, void *pArg, uint32_t count, uint32_t threads, uint32_t *pSteals);
+
+#endif
@@ -0,0 +1,142 @@
+#include <string.h>
+
+#include "prof.h"
+
+// Report line, sorted on emulated cycles or host ticks
+typedef struct{
+	uint64_t key;
+	uint16_t idx;
+}Prof_Entry;
+
+static int prof_Compare(const void *a, const void *b){
+	const Prof_Entry *x = (const Prof_Entry*)a, *y = (const Prof_Entry*)b;
+	if (x->key != y->key)
+		return x->key < y->key ? 1 : -1;
+	return x->idx - y->idx;
+}
+
+Prof* prof_Init(const char *path){
+	Prof *prof = (Prof*)calloc(1, sizeof(Prof));
+	if (!prof)
+		return NULL;
+	if (path){
+		prof->path = (char*)malloc(strlen(path) + 1);
+		if (!prof->path){
+			free(prof);
+			return NULL;
+		}
+		strcpy(prof->path, path);
+	}
+	return prof;
+}
+
+// Executed opcodes sorted on emulated cycles, returns number of entries
+static uint16_t prof_SortOpcodes(const Prof *pProf, Prof_Entry *pEntries){
+	uint16_t i, n = 0;
+
+	for (i = 0; i < CPU_OPCODES; i++){
+		if (!pProf->count[i])
+			continue;
+		pEntries[n].key = pProf->cycles[i];
+		pEntries[n].idx = i;
+		n++;
+	}
+	qsort(pEntries, n, sizeof(Prof_Entry), prof_Compare);
+	return n;
+}
+
+static void prof_PrintOpcode(FILE *f, uint16_t idx){
+	if (idx & CPU_PAGE1)
+		fprintf(f, "CB %02X", idx & 0xFF);
+	else
+		fprintf(f, "%02X", idx);
+	return;
+}
+
+static void prof_WriteCsv(const Prof *pProf, FILE *f){
+	Prof_Entry entries[CPU_OPCODES];
+	const Cpu_Opcode *op;
+	uint16_t i, n;
+
+	n = prof_SortOpcodes(pProf, entries);
+	fprintf(f, "opcode,mnemonic,family,count,cycles,host_ticks\n");
+	for (i = 0; i < n; i++){
+		op = cpu_GetOpcode(entries[i].idx);
+		prof_PrintOpcode(f, entries[i].idx);
+		fprintf(f, ",\"%s\",%s,%llu,%llu,%llu\n", op->mnemonic, cpu_GetFamilyName(op->family),
+			(unsigned long long)pProf->count[entries[i].idx], (unsigned long long)pProf->cycles[entries[i].idx],
+			(unsigned long long)pProf->ticks[entries[i].idx]);
+	}
+	return;
+}
+
+static void prof_PrintTable(const Prof *pProf){
+	Prof_Entry entries[CPU_OPCODES];
+	uint64_t family_count[0x100] = {0}, family_ticks[0x100] = {0};
+	uint64_t total_count = 0, total_cycles = 0, total_ticks = 0;
+	const Cpu_Opcode *op;
+	uint16_t i, n;
+
+	n = prof_SortOpcodes(pProf, entries);
+	for (i = 0; i < n; i++){
+		op = cpu_GetOpcode(entries[i].idx);
+		family_count[op->family] += pProf->count[entries[i].idx];
+		family_ticks[op->family] += pProf->ticks[entries[i].idx];
+		total_count += pProf->count[entries[i].idx];
+		total_cycles += pProf->cycles[entries[i].idx];
+		total_ticks += pProf->ticks[entries[i].idx];
+	}
+	if (!total_count)
+		return;
+
+	printf("Opcode profile: %llu instructions, %llu clock cycles\n", (unsigned long long)total_count, (unsigned long long)total_cycles);
+	printf("opcode\tmnemonic\t\tcount\t\tcycles\t\t%% cycles\n");
+	for (i = 0; i < n; i++){
+		op = cpu_GetOpcode(entries[i].idx);
+		prof_PrintOpcode(stdout, entries[i].idx);
+		printf("\t%-16s\t%12llu\t%12llu\t%6.2f\n", op->mnemonic, (unsigned long long)pProf->count[entries[i].idx],
+			(unsigned long long)pProf->cycles[entries[i].idx], 100.0 * pProf->cycles[entries[i].idx] / total_cycles);
+	}
+
+	// Host time per handler family
+	for (n = 0, i = 0; cpu_GetFamilyName(i); i++){
+		if (!family_count[i])
+			continue;
+		entries[n].key = family_ticks[i];
+		entries[n].idx = i;
+		n++;
+	}
+	qsort(entries, n, sizeof(Prof_Entry), prof_Compare);
+	printf("\nHost time per handler family: %llu ticks\n", (unsigned long long)total_ticks);
+	printf("family\t\tcount\t\tticks\t\tticks/op\t%% ticks\n");
+	for (i = 0; i < n; i++){
+		printf("%-12s\t%12llu\t%12llu\t%8.1f\t%6.2f\n", cpu_GetFamilyName(entries[i].idx),
+			(unsigned long long)family_count[entries[i].idx], (unsigned long long)family_ticks[entries[i].idx],
+			(double)family_ticks[entries[i].idx] / family_count[entries[i].idx],
+			total_ticks ? 100.0 * family_ticks[entries[i].idx] / total_ticks : 0.0);
+	}
+	return;
+}
+
+void prof_Report(const Prof *pProf){
+	FILE *f = NULL;
+
+	if (!pProf->path){
+		prof_PrintTable(pProf);
+		return;
+	}
+	f = fopen(pProf->path, "w");
+	if (!f){
+		printf("Could not write profile %s\n", pProf->path);
+		return;
+	}
+	prof_WriteCsv(pProf, f);
+	fclose(f);
+	return;
+}
+
+void prof_Free(Prof *pProf){
+	free(pProf->path);
+	free(pProf);
+	return;
+}
@@ -0,0 +1,62 @@
+#ifndef _PROF_H
+#define _PROF_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "cpu.h"
+
+/*
+
+	Opcode profiler
+
+	Counts executions and emulated clock cycles of every page0 and page1
+	opcode while attached to a Cpu, and the host time spent in each
+	handler family (rdtsc on x86, clock_gettime elsewhere). Native blocks
+	and idle loop skipping are disabled while profiling so every
+	instruction goes through the interpreter and is counted.
+
+	The report is written by vm_Quit: a table sorted on emulated cycles,
+	or CSV when a path was given.
+
+*/
+
+// Profiler structure
+typedef struct Prof{
+	uint64_t count[CPU_OPCODES]; // executions per opcode, page1 offset by CPU_PAGE1
+	uint64_t cycles[CPU_OPCODES]; // emulated clock cycles per opcode
+	uint64_t ticks[CPU_OPCODES]; // host ticks per opcode, reported per handler family
+	char *path; // CSV output, NULL prints a table to stdout
+}Prof;
+
+// Initialize and return a profiler, path NULL reports a table
+Prof* prof_Init(const char *path);
+// Write report, table or CSV
+void prof_Report(const Prof *pProf);
+// Free profiler
+void prof_Free(Prof *pProf);
+
+// Host timestamp, only differences are meaningful
+static inline uint64_t prof_Ticks(void){
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+// Account one executed instruction
+static inline void prof_Record(Prof *pProf, uint16_t idx, uint32_t cycles, uint64_t ticks){
+	pProf->count[idx]++;
+	pProf->cycles[idx] += cycles;
+	pProf->ticks[idx] += ticks;
+}
+
+#endif
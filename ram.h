@@ -3,7 +3,8 @@
 
 #include <stdint.h>
 
-#define RAM_SIZE (0x8000)
+#define RAM_SIZE (0x8000) // without a cartridge
+#define RAM_SIZE_MAX (0x20000) // MBC5, 16 banks
 #define RAM_BANK_SIZE (0x2000)
 
 #endif
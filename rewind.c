@@ -0,0 +1,232 @@
+#include "rewind.h"
+
+Rewind* rewind_Init(uint32_t frames, size_t cap, uint32_t keyframe){
+	Rewind *rew = (Rewind*)calloc(1, sizeof(Rewind));
+	if (!rew)
+		return NULL;
+	rew->frames = frames < 2 ? 2 : frames;
+	rew->cap = cap ? cap : REWIND_CAP;
+	if (rew->cap < 2 * REWIND_CODE_MAX)
+		rew->cap = 2 * REWIND_CODE_MAX; // room for a keyframe whatever the state
+	rew->keyframe = keyframe ? keyframe : REWIND_KEYFRAME;
+	rew->entries = (Rewind_Entry*)malloc(rew->frames * sizeof(Rewind_Entry));
+	rew->data = (uint8_t*)malloc(rew->cap);
+	rew->state = (uint8_t*)malloc(VM_STATE_MAX);
+	rew->next = (uint8_t*)malloc(VM_STATE_MAX);
+	rew->code = (uint8_t*)malloc(2 * REWIND_CODE_MAX);
+	if (!rew->entries || !rew->data || !rew->state || !rew->next || !rew->code){
+		rewind_Free(rew);
+		return NULL;
+	}
+	return rew;
+}
+
+static uint8_t* rewind_PutSize(uint8_t *pOut, uint32_t n){
+	while (n >= 0x80){
+		*pOut++ = n | 0x80;
+		n >>= 7;
+	}
+	*pOut++ = n;
+	return pOut;
+}
+
+static const uint8_t* rewind_GetSize(const uint8_t *pIn, uint32_t *pN){
+	uint32_t shift = 0;
+
+	*pN = 0;
+	do{
+		*pN |= (uint32_t)(*pIn & 0x7F) << shift;
+		shift += 7;
+	}while (*pIn++ & 0x80);
+	return pIn;
+}
+
+// Byte of the XOR of a and b, b NULL stands for zeros
+#define REWIND_XOR(a, b, i) ((a)[i] ^ ((b) ? (b)[i] : 0))
+
+// Returns 1 if REWIND_MIN_RUN zero bytes of the XOR, or its end, start at i
+static inline uint8_t rewind_ZeroRun(const uint8_t *a, const uint8_t *b, uint32_t i, uint32_t size){
+	uint32_t j;
+	for (j = i; j < size && j < i + REWIND_MIN_RUN; j++)
+		if (REWIND_XOR(a, b, j))
+			return 0;
+	return 1;
+}
+
+// Run length encode the XOR of a and b as (zero bytes, literal bytes, literals) runs, returns encoded size
+static uint32_t rewind_Encode(const uint8_t *a, const uint8_t *b, uint32_t size, uint8_t *pOut){
+	uint8_t *out = pOut;
+	uint32_t i = 0, zeros, literals;
+	uint64_t x, y;
+
+	while (i < size){
+		zeros = i;
+		// Equal words first, the XOR is mostly zero
+		while (i + sizeof(uint64_t) <= size){
+			memcpy(&x, &a[i], sizeof(uint64_t));
+			y = 0;
+			if (b)
+				memcpy(&y, &b[i], sizeof(uint64_t));
+			if (x != y)
+				break;
+			i += sizeof(uint64_t);
+		}
+		while (i < size && !REWIND_XOR(a, b, i))
+			i++;
+		zeros = i - zeros;
+		if (i == size)
+			break; // trailing zeros are implied
+		literals = i;
+		while (i < size && !rewind_ZeroRun(a, b, i, size))
+			i++;
+		literals = i - literals;
+		out = rewind_PutSize(out, zeros);
+		out = rewind_PutSize(out, literals);
+		for (; literals; literals--, out++)
+			*out = REWIND_XOR(a, b, i - literals);
+	}
+	return out - pOut;
+}
+
+// XOR encoded runs into state
+static void rewind_Decode(const uint8_t *pCode, uint32_t size, uint8_t *pState){
+	const uint8_t *end = pCode + size;
+	uint32_t i = 0, zeros, literals;
+
+	while (pCode < end){
+		pCode = rewind_GetSize(pCode, &zeros);
+		pCode = rewind_GetSize(pCode, &literals);
+		for (i += zeros; literals; literals--)
+			pState[i++] ^= *pCode++;
+	}
+	return;
+}
+
+static Rewind_Entry* rewind_Entry(Rewind *pRew, uint32_t idx){
+	return &pRew->entries[(pRew->first + idx) % pRew->frames];
+}
+
+static void rewind_DropOldest(Rewind *pRew){
+	Rewind_Entry *entry = rewind_Entry(pRew, 0);
+	pRew->used -= entry->delta_size + entry->key_size;
+	pRew->first = (pRew->first + 1) % pRew->frames;
+	pRew->count--;
+	return;
+}
+
+// Append a frame of size bytes, dropping the oldest ones in its way
+static Rewind_Entry* rewind_Append(Rewind *pRew, uint32_t size){
+	Rewind_Entry *entry, *first, *last;
+	size_t offset = 0;
+	uint32_t lap = 0;
+
+	if (pRew->count == pRew->frames)
+		rewind_DropOldest(pRew);
+	while (pRew->count){
+		first = rewind_Entry(pRew, 0);
+		last = rewind_Entry(pRew, pRew->count - 1);
+		offset = last->offset + last->delta_size + last->key_size;
+		lap = last->lap;
+		if (first->lap == lap){
+			// Frames in one piece, after the newest or from the start of the buffer
+			if (offset + size <= pRew->cap)
+				break;
+			if (size <= first->offset){
+				offset = 0;
+				lap++;
+				break;
+			}
+		}else if (offset + size <= first->offset)
+			break; // between the newest and the oldest frame
+		rewind_DropOldest(pRew);
+		offset = 0;
+		lap = 0;
+	}
+	entry = rewind_Entry(pRew, pRew->count++);
+	entry->offset = offset;
+	entry->lap = lap;
+	pRew->used += size;
+	return entry;
+}
+
+int8_t rewind_Push(Rewind *pRew, const VM *pVm){
+	Rewind_Entry *entry;
+	uint32_t delta = 0, key = 0;
+	size_t size = vm_StateSize(pVm);
+	uint8_t *swap;
+
+	if (vm_SaveState(pVm, pRew->next, size) != 0)
+		return -1;
+	// Another cartridge RAM size, the older frames do not XOR with this one
+	if (size != pRew->state_size){
+		pRew->first = 0;
+		pRew->count = 0;
+		pRew->used = 0;
+		pRew->state_size = size;
+	}
+	if (pRew->count)
+		delta = rewind_Encode(pRew->next, pRew->state, size, pRew->code);
+	if (!pRew->count || pRew->since_key + 1 >= pRew->keyframe){
+		key = rewind_Encode(pRew->next, NULL, size, &pRew->code[delta]);
+		pRew->since_key = 0;
+	}else
+		pRew->since_key++;
+
+	entry = rewind_Append(pRew, delta + key);
+	entry->delta_size = delta;
+	entry->key_size = key;
+	memcpy(&pRew->data[entry->offset], pRew->code, delta + key);
+	swap = pRew->state;
+	pRew->state = pRew->next;
+	pRew->next = swap;
+	return 0;
+}
+
+int8_t rewind_Back(Rewind *pRew, VM *pVm, uint32_t frames){
+	Rewind_Entry *entry;
+	uint32_t target, key, i;
+
+	if (!frames || frames >= pRew->count)
+		return -1;
+	target = pRew->count - 1 - frames;
+
+	// Newest keyframe at or before target, frames after the keyframe are decoded forward
+	for (key = target + 1; key && !rewind_Entry(pRew, key - 1)->key_size; key--)
+		;
+	if (key && target - (key - 1) < frames){
+		entry = rewind_Entry(pRew, key - 1);
+		memset(pRew->state, 0, pRew->state_size);
+		rewind_Decode(&pRew->data[entry->offset + entry->delta_size], entry->key_size, pRew->state);
+		for (i = key; i <= target; i++){
+			entry = rewind_Entry(pRew, i);
+			rewind_Decode(&pRew->data[entry->offset], entry->delta_size, pRew->state);
+		}
+	}else{
+		for (i = pRew->count - 1; i > target; i--){
+			entry = rewind_Entry(pRew, i);
+			rewind_Decode(&pRew->data[entry->offset], entry->delta_size, pRew->state);
+		}
+	}
+
+	for (i = target + 1; i < pRew->count; i++){
+		entry = rewind_Entry(pRew, i);
+		pRew->used -= entry->delta_size + entry->key_size;
+	}
+	pRew->count = target + 1;
+	pRew->since_key = key ? target - (key - 1) : pRew->keyframe;
+	return vm_LoadState(pVm, pRew->state, pRew->state_size) == 0 ? 0 : -1;
+}
+
+int8_t rewind_Step(Rewind *pRew, VM *pVm){
+	return rewind_Back(pRew, pVm, 1);
+}
+
+void rewind_Free(Rewind *pRew){
+	free(pRew->entries);
+	free(pRew->data);
+	free(pRew->state);
+	free(pRew->next);
+	free(pRew->code);
+	free(pRew);
+	return;
+}
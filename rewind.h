@@ -0,0 +1,73 @@
+#ifndef _REWIND_H
+#define _REWIND_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vm.h"
+
+/*
+
+	Rewind buffer
+
+	Keeps the machine state (vm_SaveState image: Cpu, memory descriptors,
+	RAM, VRAM, IO ports) of the last frames in a ring of fixed size.
+	A frame is stored as the XOR of its state with the state of the frame
+	before it, run length encoded: a frame mostly writes the same few
+	pages, the XOR is mostly zero and encodes to a few dozen bytes.
+
+	The state of the newest frame is kept whole. XOR being its own
+	inverse, stepping back one frame applies the newest delta to it, the
+	cost does not depend on how far back the history goes. Every
+	keyframe frames the full state is stored too, going back many frames
+	at once starts from the nearest keyframe when it is closer.
+
+	The oldest frames are dropped when the frame count or the byte budget
+	is reached, every frame when a cartridge with another RAM size is
+	loaded. A rewind buffer is used from the thread running its VM.
+
+*/
+
+#define REWIND_KEYFRAME (128) // default frames between full states
+#define REWIND_CAP (8 << 20) // default byte budget
+#define REWIND_MIN_RUN (4) // zero bytes ending a literal run
+#define REWIND_CODE_MAX (VM_STATE_MAX * 3 / 2 + 16) // encoded state, a literal byte costs at most 1.4 bytes
+
+// Frame in the ring
+typedef struct{
+	size_t offset; // in data
+	uint32_t lap; // frames on another lap than the oldest one wrapped around the end of data
+	uint32_t delta_size; // XOR with the frame before, 0 for the first frame
+	uint32_t key_size; // full state after the delta, 0 if not a keyframe
+}Rewind_Entry;
+
+// Rewind buffer structure
+typedef struct Rewind{
+	Rewind_Entry *entries; // ring, oldest at first
+	uint32_t frames; // ring size
+	uint32_t first;
+	uint32_t count;
+	uint32_t keyframe;
+	uint32_t since_key; // frames after the newest keyframe
+	uint8_t *data; // encoded frames
+	size_t cap;
+	size_t used;
+	uint8_t *state; // state of the newest frame, state_size bytes
+	uint8_t *next; // state being pushed
+	uint8_t *code; // encoding buffer, delta then keyframe
+	size_t state_size; // vm_StateSize of the recorded VM
+}Rewind;
+
+// Initialize a rewind buffer of frames frames and cap bytes, 0 uses REWIND_CAP and keyframe 0 REWIND_KEYFRAME
+Rewind* rewind_Init(uint32_t frames, size_t cap, uint32_t keyframe);
+// Record the VM state as the newest frame, returns 0 on success
+int8_t rewind_Push(Rewind *pRew, const VM *pVm);
+// Load the state frames before the newest one and drop the frames after it, returns 0 on success
+int8_t rewind_Back(Rewind *pRew, VM *pVm, uint32_t frames);
+// Go back one frame, returns -1 when there is no frame before the newest one
+int8_t rewind_Step(Rewind *pRew, VM *pVm);
+// Free rewind buffer
+void rewind_Free(Rewind *pRew);
+
+#endif
@@ -3,7 +3,12 @@
 
 #include <stdint.h>
 
-#define ROM_SIZE (0x8000) // non-MBCx games (tetris, ...)
+#define ROM_SIZE (0x8000) // non-MBCx games (tetris, ...), smallest cartridge
 #define ROM_BANK_SIZE (0x4000)
+#define ROM_HEADER_TYPE (0x0147) // mapper and cartridge hardware
+#define ROM_HEADER_ROM_SIZE (0x0148) // ROM size code, 32KB << code
+#define ROM_SIZE_CODE_MAX (0x08) // 8MB
+#define ROM_HEADER_RAM_SIZE (0x0149) // cartridge RAM size code
+#define ROM_HEADER_CHECKSUM (0x014D) // header checksum, global checksum follows at $014E - $014F
 
 #endif
@@ -0,0 +1,95 @@
+#include "sched.h"
+
+static void sched_Swap(Scheduler *pSched, uint8_t i, uint8_t j){
+	Sched_Event tmp = pSched->heap[i];
+	pSched->heap[i] = pSched->heap[j];
+	pSched->heap[j] = tmp;
+	pSched->pos[pSched->heap[i].type] = i;
+	pSched->pos[pSched->heap[j].type] = j;
+	return;
+}
+
+// Restore heap order from index i, returns final index
+static uint8_t sched_Up(Scheduler *pSched, uint8_t i){
+	uint8_t parent;
+	while (i > 0){
+		parent = (i - 1) / 2;
+		if (pSched->heap[parent].deadline <= pSched->heap[i].deadline)
+			break;
+		sched_Swap(pSched, i, parent);
+		i = parent;
+	}
+	return i;
+}
+
+static void sched_Down(Scheduler *pSched, uint8_t i){
+	uint8_t child, min;
+	for (;;){
+		min = i;
+		child = 2 * i + 1;
+		if (child < pSched->count && pSched->heap[child].deadline < pSched->heap[min].deadline)
+			min = child;
+		child++;
+		if (child < pSched->count && pSched->heap[child].deadline < pSched->heap[min].deadline)
+			min = child;
+		if (min == i)
+			break;
+		sched_Swap(pSched, i, min);
+		i = min;
+	}
+	return;
+}
+
+static void sched_UpdateNext(Scheduler *pSched){
+	pSched->next = pSched->count ? pSched->heap[0].deadline : SCHED_NEVER;
+	return;
+}
+
+void sched_Init(Scheduler *pSched){
+	uint8_t i;
+	pSched->count = 0;
+	for (i = 0; i < SCHED_EVENTS; i++)
+		pSched->pos[i] = SCHED_NONE;
+	sched_UpdateNext(pSched);
+	return;
+}
+
+void sched_Add(Scheduler *pSched, uint8_t type, uint64_t deadline){
+	uint8_t i = pSched->pos[type];
+
+	if (i == SCHED_NONE){
+		i = pSched->count++;
+		pSched->heap[i].type = type;
+		pSched->pos[type] = i;
+	}
+	pSched->heap[i].deadline = deadline;
+	sched_Down(pSched, sched_Up(pSched, i));
+	sched_UpdateNext(pSched);
+	return;
+}
+
+void sched_Remove(Scheduler *pSched, uint8_t type){
+	uint8_t i = pSched->pos[type];
+
+	if (i == SCHED_NONE)
+		return;
+	pSched->count--;
+	if (i != pSched->count){
+		sched_Swap(pSched, i, pSched->count);
+		sched_Down(pSched, sched_Up(pSched, i));
+	}
+	pSched->pos[type] = SCHED_NONE;
+	sched_UpdateNext(pSched);
+	return;
+}
+
+uint8_t sched_Pop(Scheduler *pSched, uint64_t *pDeadline){
+	uint8_t type;
+
+	if (!pSched->count)
+		return SCHED_NONE;
+	type = pSched->heap[0].type;
+	*pDeadline = pSched->heap[0].deadline;
+	sched_Remove(pSched, type);
+	return type;
+}
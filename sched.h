@@ -0,0 +1,62 @@
+#ifndef _DG_SCHED_H
+#define _DG_SCHED_H
+
+#include <stdint.h>
+
+/*
+
+	Event scheduler
+
+	Timed hardware events (LCD mode changes, VBlank, serial transfer end,
+	timer overflow) are kept in a binary min heap ordered on their
+	clock_cycle deadline, each event type is scheduled at most once. The
+	Cpu runs until the earliest deadline and fires the due events, no
+	subsystem is ticked per instruction.
+
+	Handlers get the deadline of their event and schedule the next one
+	relative to it, events firing late (after a native block or a long
+	instruction) do not drift.
+
+*/
+
+// Event types
+#define SCHED_EVENT_LCD (0) // LCD mode change, VBlank on line 144
+#define SCHED_EVENT_SERIAL (1) // serial transfer complete
+#define SCHED_EVENT_TIMER (2) // TIMA overflow
+#define SCHED_EVENT_PROFILE (3) // call stack profiler sample
+#define SCHED_EVENTS (4)
+
+#define SCHED_NONE (0xFF) // heap position of an event not scheduled
+#define SCHED_NEVER (UINT64_MAX)
+
+// Scheduled event
+typedef struct{
+	uint64_t deadline; // clock_cycle the event fires at
+	uint8_t type;
+}Sched_Event;
+
+// Scheduler structure, holds no pointers
+typedef struct{
+	uint64_t next; // earliest deadline, SCHED_NEVER when nothing is scheduled
+	Sched_Event heap[SCHED_EVENTS];
+	uint8_t pos[SCHED_EVENTS]; // heap index of each event type, SCHED_NONE when not scheduled
+	uint8_t count;
+}Scheduler;
+
+// Clear all events
+void sched_Init(Scheduler *pSched);
+// Schedule event type at deadline, moves it when already scheduled
+void sched_Add(Scheduler *pSched, uint8_t type, uint64_t deadline);
+// Cancel event type
+void sched_Remove(Scheduler *pSched, uint8_t type);
+// Remove earliest event, returns its type and stores its deadline
+uint8_t sched_Pop(Scheduler *pSched, uint64_t *pDeadline);
+
+// Returns deadline of event type, SCHED_NEVER when not scheduled
+static inline uint64_t sched_Deadline(const Scheduler *pSched, uint8_t type){
+	if (pSched->pos[type] == SCHED_NONE)
+		return SCHED_NEVER;
+	return pSched->heap[pSched->pos[type]].deadline;
+}
+
+#endif
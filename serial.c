@@ -0,0 +1,45 @@
+#include <stdlib.h>
+
+#include "serial.h"
+
+void serial_Control(Cpu *pCpu){
+	if (pCpu->sfr->SC_bits.transfer_flag && pCpu->sfr->SC_bits.clock)
+		sched_Add(&pCpu->sched, SCHED_EVENT_SERIAL, pCpu->clock_cycle + SERIAL_TRANSFER_CYCLES);
+	else
+		sched_Remove(&pCpu->sched, SCHED_EVENT_SERIAL);
+	return;
+}
+
+void serial_Event(Cpu *pCpu, uint64_t deadline){
+	Serial_Out *out = pCpu->serial_out;
+
+	if (out){
+		if (out->count < out->size)
+			out->data[out->count++] = pCpu->sfr->SB;
+		else
+			out->lost++;
+	}
+	pCpu->sfr->SB = 0xFF;
+	pCpu->sfr->SC_bits.transfer_flag = 0;
+	pCpu->sfr->IF_bits.serial_transfer_complete = 1;
+	return;
+}
+
+Serial_Out* serial_OutInit(uint32_t size){
+	Serial_Out *out = (Serial_Out*)calloc(1, sizeof(Serial_Out));
+	if (!out)
+		return NULL;
+	out->data = (uint8_t*)malloc(size);
+	if (!out->data){
+		free(out);
+		return NULL;
+	}
+	out->size = size;
+	return out;
+}
+
+void serial_OutFree(Serial_Out *pOut){
+	free(pOut->data);
+	free(pOut);
+	return;
+}
@@ -0,0 +1,39 @@
+#ifndef _SERIAL_H
+#define _SERIAL_H
+
+#include "cpu.h"
+
+/*
+
+	Serial port
+
+	A transfer started with the internal clock shifts 8 bits at 8192Hz,
+	completion runs on SCHED_EVENT_SERIAL. No link partner is connected,
+	the byte received is $FF. Transfers on the external clock never end.
+
+	Bytes sent can be captured in a Serial_Out attached to the Cpu, test
+	ROMs print their results this way.
+
+*/
+
+#define SERIAL_TRANSFER_CYCLES (4096) // 8 bits at 8192Hz
+
+// Captured serial output
+typedef struct Serial_Out{
+	uint8_t *data;
+	uint32_t count; // bytes captured
+	uint32_t size; // capacity, bytes past it are dropped
+	uint32_t lost; // bytes dropped
+}Serial_Out;
+
+// Start or cancel transfer after a write to SC
+void serial_Control(Cpu *pCpu);
+// SCHED_EVENT_SERIAL handler
+void serial_Event(Cpu *pCpu, uint64_t deadline);
+
+// Initialize and return a capture buffer of size bytes
+Serial_Out* serial_OutInit(uint32_t size);
+// Free capture buffer
+void serial_OutFree(Serial_Out *pOut);
+
+#endif
@@ -0,0 +1,148 @@
+#include "snap.h"
+
+// Internal RAM, VRAM and the cartridge RAM of the loaded cartridge
+static uint32_t snap_PageCount(const VM *pVm){
+	return (VM_STATE_FIXED - VM_STATE_CPU + pVm->RAM->size) / MEM_PAGE_SIZE;
+}
+
+Snap_Pool* snap_Init(VM *pVm){
+	Snap_Pool *pool = (Snap_Pool*)calloc(1, sizeof(Snap_Pool));
+	if (!pool)
+		return NULL;
+	pool->vm = pVm;
+	pool->base = pVm->arena->internal_ram;
+	pool->page_count = snap_PageCount(pVm);
+	memset(pool->dirty, 1, sizeof(pool->dirty));
+	pVm->cpu->snap = pool;
+	return pool;
+}
+
+// Returns a free page with one reference, NULL when out of memory
+static Snap_Page* snap_AllocPage(Snap_Pool *pPool){
+	Snap_Page *page, *chunk, **chunks;
+	uint32_t i;
+
+	if (!pPool->free_pages){
+		chunks = (Snap_Page**)realloc(pPool->chunks, (pPool->chunk_count + 1) * sizeof(Snap_Page*));
+		if (!chunks)
+			return NULL;
+		pPool->chunks = chunks;
+		chunk = (Snap_Page*)malloc(SNAP_CHUNK_PAGES * sizeof(Snap_Page));
+		if (!chunk)
+			return NULL;
+		pPool->chunks[pPool->chunk_count++] = chunk;
+		for (i = 0; i < SNAP_CHUNK_PAGES; i++){
+			chunk[i].next_free = pPool->free_pages;
+			pPool->free_pages = &chunk[i];
+		}
+	}
+	page = pPool->free_pages;
+	pPool->free_pages = page->next_free;
+	page->refs = 1;
+	return page;
+}
+
+static void snap_ReleasePage(Snap_Pool *pPool, Snap_Page *pPage){
+	if (--pPage->refs)
+		return;
+	pPage->next_free = pPool->free_pages;
+	pPool->free_pages = pPage;
+	return;
+}
+
+// New parent, written pages are tracked from here
+static void snap_SetParent(Snap_Pool *pPool, Snap *pSnap){
+	pSnap->refs++;
+	if (pPool->parent)
+		snap_Release(pPool, pPool->parent);
+	pPool->parent = pSnap;
+	memset(pPool->dirty, 0, sizeof(pPool->dirty));
+	pPool->dirty[SNAP_PAGE_IO] = 1;
+	return;
+}
+
+Snap* snap_Take(Snap_Pool *pPool){
+	Snap *snap = NULL, *parent = pPool->parent;
+	const uint8_t *data;
+	uint32_t i;
+
+	snap = (Snap*)malloc(sizeof(Snap));
+	if (!snap)
+		return NULL;
+	snap->refs = 1;
+	snap->page_count = pPool->page_count;
+	for (i = 0; i < snap->page_count; i++){
+		data = &pPool->base[i * MEM_PAGE_SIZE];
+		// Clean pages, and dirty ones written back to the same bytes, are shared
+		if (parent && i < parent->page_count && (!pPool->dirty[i] || !memcmp(parent->pages[i]->data, data, MEM_PAGE_SIZE))){
+			snap->pages[i] = parent->pages[i];
+			snap->pages[i]->refs++;
+			continue;
+		}
+		snap->pages[i] = snap_AllocPage(pPool);
+		if (!snap->pages[i]){
+			while (i--)
+				snap_ReleasePage(pPool, snap->pages[i]);
+			free(snap);
+			return NULL;
+		}
+		memcpy(snap->pages[i]->data, data, MEM_PAGE_SIZE);
+		pPool->pages_copied++;
+	}
+	memcpy(snap->cpu, pPool->vm->arena, VM_STATE_CPU);
+	pPool->taken++;
+
+	snap_SetParent(pPool, snap);
+	cpu_UpdatePageTable(pPool->vm->cpu);
+	return snap;
+}
+
+void snap_Restore(Snap_Pool *pPool, Snap *pSnap){
+	Snap *parent = pPool->parent;
+	uint32_t i;
+
+	// Pages not written since parent only differ if the snapshot does not share them
+	for (i = 0; i < pSnap->page_count; i++){
+		if (parent && i < parent->page_count && !pPool->dirty[i] && parent->pages[i] == pSnap->pages[i])
+			continue;
+		memcpy(&pPool->base[i * MEM_PAGE_SIZE], pSnap->pages[i]->data, MEM_PAGE_SIZE);
+		pPool->pages_restored++;
+	}
+	pPool->page_count = pSnap->page_count;
+	snap_SetParent(pPool, pSnap);
+	vm_LoadCpu(pPool->vm, pSnap->cpu);
+	return;
+}
+
+void snap_Release(Snap_Pool *pPool, Snap *pSnap){
+	uint32_t i;
+
+	if (--pSnap->refs)
+		return;
+	for (i = 0; i < pSnap->page_count; i++)
+		snap_ReleasePage(pPool, pSnap->pages[i]);
+	free(pSnap);
+	return;
+}
+
+void snap_Invalidate(Snap_Pool *pPool){
+	if (pPool->parent)
+		snap_Release(pPool, pPool->parent);
+	pPool->parent = NULL;
+	pPool->page_count = snap_PageCount(pPool->vm);
+	memset(pPool->dirty, 1, sizeof(pPool->dirty));
+	return;
+}
+
+void snap_Free(Snap_Pool *pPool){
+	uint32_t i;
+
+	snap_Invalidate(pPool);
+	pPool->vm->cpu->snap = NULL;
+	cpu_UpdatePageTable(pPool->vm->cpu);
+	for (i = 0; i < pPool->chunk_count; i++)
+		free(pPool->chunks[i]);
+	free(pPool->chunks);
+	free(pPool);
+	return;
+}
@@ -0,0 +1,106 @@
+#ifndef _SNAP_H
+#define _SNAP_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vm.h"
+
+/*
+
+	Copy on write snapshot pool
+
+	Guest RAM (internal RAM, OAM, IO ports and HRAM, VRAM, cartridge RAM)
+	is tracked in 256 byte pages, the page table granularity. After a
+	snapshot every tracked page is clean and write protected: the first
+	write to it goes through cpu_WriteControl, which marks it dirty and
+	maps it writable again. Later writes run at full speed.
+
+	A snapshot only copies the pages dirtied since its parent, the last
+	snapshot taken or restored, and shares every other page with it.
+	Pages are reference counted and freed when no snapshot holds them, a
+	tree of snapshots forked from the same state costs one page per page
+	written on each branch. The Cpu and memory descriptors before the RAM
+	(VM_STATE_CPU bytes) are copied whole. Only the cartridge RAM of the
+	loaded cartridge is tracked.
+
+	The IO page is always dirty, the timer, LCD and serial update their
+	registers without going through the write path.
+
+	A pool belongs to one VM and is used from the thread running it.
+	Snapshots must be released before the pool is freed, vm_Quit frees
+	the pool attached to its VM.
+
+*/
+
+#define SNAP_PAGES ((VM_STATE_FIXED - VM_STATE_CPU + RAM_SIZE_MAX) / MEM_PAGE_SIZE) // tracked pages at most
+#define SNAP_PAGE_IO ((MEM_IO_PORTS_OFFSET - MEM_RAM_INTERNAL_OFFSET) / MEM_PAGE_SIZE)
+#define SNAP_CHUNK_PAGES (1024) // pages allocated at once
+
+// Page copy shared by snapshots
+typedef struct Snap_Page{
+	uint32_t refs;
+	struct Snap_Page *next_free;
+	uint8_t data[MEM_PAGE_SIZE];
+}Snap_Page;
+
+// Snapshot, RAM pages and the state before them
+typedef struct{
+	uint32_t refs;
+	uint32_t page_count; // used in pages
+	Snap_Page *pages[SNAP_PAGES];
+	uint8_t cpu[VM_STATE_CPU];
+}Snap;
+
+// Snapshot pool structure
+typedef struct Snap_Pool{
+	VM *vm;
+	uint8_t *base; // tracked RAM, internal RAM of the VM arena
+	uint32_t page_count; // tracked pages, the cartridge RAM of the loaded cartridge included
+	Snap *parent; // last snapshot taken or restored, NULL before the first one
+	uint8_t dirty[SNAP_PAGES]; // written since parent
+	Snap_Page *free_pages;
+	Snap_Page **chunks;
+	uint32_t chunk_count;
+	uint64_t taken;
+	uint64_t pages_copied; // on snapshot, shared pages not counted
+	uint64_t pages_restored;
+}Snap_Pool;
+
+// Initialize a pool and attach it to the VM, returns NULL when out of memory
+Snap_Pool* snap_Init(VM *pVm);
+// Snapshot the VM, returns NULL when out of memory
+Snap* snap_Take(Snap_Pool *pPool);
+// Restore the VM to a snapshot of this pool, the snapshot stays valid
+void snap_Restore(Snap_Pool *pPool, Snap *pSnap);
+// Drop a reference to a snapshot, freed with its unshared pages on the last one
+void snap_Release(Snap_Pool *pPool, Snap *pSnap);
+// RAM changed outside of the write path (vm_LoadState, vm_LoadRom), every page is dirty
+void snap_Invalidate(Snap_Pool *pPool);
+// Detach pool from its VM and free it
+void snap_Free(Snap_Pool *pPool);
+
+// Tracked page index of a host address, -1 outside of the tracked RAM
+static inline int32_t snap_PageIndex(const Snap_Pool *pPool, const uint8_t *pHost){
+	if (pHost < pPool->base || pHost >= pPool->base + pPool->page_count * MEM_PAGE_SIZE)
+		return -1;
+	return (pHost - pPool->base) / MEM_PAGE_SIZE;
+}
+
+// Returns 1 if host page is tracked and not written since the last snapshot
+static inline uint8_t snap_Clean(const Snap_Pool *pPool, const uint8_t *pPage){
+	int32_t idx = snap_PageIndex(pPool, pPage);
+	return idx >= 0 && !pPool->dirty[idx];
+}
+
+// Write to host page, returns 1 if it was clean
+static inline uint8_t snap_Write(Snap_Pool *pPool, const uint8_t *pPage){
+	int32_t idx = snap_PageIndex(pPool, pPage);
+	if (idx < 0 || pPool->dirty[idx])
+		return 0;
+	pPool->dirty[idx] = 1;
+	return 1;
+}
+
+#endif
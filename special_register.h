@@ -227,7 +227,7 @@ union Special_Register{
 				uint8_t all_sound_on : 1;
 			}NR_52_bits;
 		};
-		uint8_t unused4[0x3]; // FF27-FF29
+		uint8_t unused4[0x9]; // FF27-FF2F
 		uint8_t wave_pattern[0x10]; // FF30-FF3F
 		union{
 			uint8_t LCDC; // FF40 - #91 on reset
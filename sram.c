@@ -0,0 +1,158 @@
+#define _GNU_SOURCE // mremap
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "sram.h"
+#include "snap.h"
+
+static void* sram_Thread(void *pArg){
+	Sram *sram = (Sram*)pArg;
+	struct timespec until;
+
+	pthread_mutex_lock(&sram->lock);
+	while (!sram->quit){
+		clock_gettime(CLOCK_REALTIME, &until);
+		until.tv_sec += sram->interval_ms / 1000;
+		until.tv_nsec += (long)(sram->interval_ms % 1000) * 1000000;
+		if (until.tv_nsec >= 1000000000){
+			until.tv_sec++;
+			until.tv_nsec -= 1000000000;
+		}
+		while (!sram->pending && !sram->quit)
+			if (pthread_cond_timedwait(&sram->wake, &sram->lock, &until) == ETIMEDOUT)
+				break;
+		sram->pending = 0;
+
+		// Emulation thread may ask for the next flush meanwhile
+		pthread_mutex_unlock(&sram->lock);
+		msync(sram->data, sram->size, MS_SYNC);
+		pthread_mutex_lock(&sram->lock);
+		sram->flushes++;
+	}
+	pthread_mutex_unlock(&sram->lock);
+	return NULL;
+}
+
+// Move the pages of map over the arena RAM in one step, the arena never has a hole,
+// returns 0 on success, -1 with the arena RAM unchanged and map unmapped
+static int8_t sram_Move(void *pMap, uint8_t *pData, size_t size){
+#if defined(MREMAP_FIXED)
+	if (mremap(pMap, size, size, MREMAP_MAYMOVE | MREMAP_FIXED, pData) != MAP_FAILED)
+		return 0;
+#endif
+	munmap(pMap, size);
+	return -1;
+}
+
+// Anonymous pages holding a copy of the RAM replace the file mapping, returns 0 on success,
+// -1 with the file still mapped, it loses no write
+static int8_t sram_Detach(Sram *pSram){
+	void *copy = mmap(NULL, pSram->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (copy == MAP_FAILED)
+		return -1;
+	memcpy(copy, pSram->data, pSram->size);
+	return sram_Move(copy, pSram->data, pSram->size);
+}
+
+// Stop the flush thread and write the file back
+static void sram_Stop(Sram *pSram){
+	pthread_mutex_lock(&pSram->lock);
+	pSram->quit = 1;
+	pthread_cond_signal(&pSram->wake);
+	pthread_mutex_unlock(&pSram->lock);
+	pthread_join(pSram->thread, NULL);
+	msync(pSram->data, pSram->size, MS_SYNC);
+	fsync(pSram->fd);
+	return;
+}
+
+static void sram_Release(Sram *pSram){
+	close(pSram->fd);
+	pthread_mutex_destroy(&pSram->lock);
+	pthread_cond_destroy(&pSram->wake);
+	pSram->cpu->sram = NULL;
+	free(pSram);
+	return;
+}
+
+Sram* sram_Open(VM *pVm, const char *path, uint32_t interval_ms){
+	Sram *sram = NULL;
+	struct stat st;
+	uint8_t *data = pVm->arena->ram;
+	size_t size = pVm->RAM->size;
+	void *map;
+	int fd;
+
+	if (!size || (uintptr_t)data % sysconf(_SC_PAGESIZE) || size % sysconf(_SC_PAGESIZE))
+		return NULL;
+	if (pVm->cpu->sram && sram_Close(pVm->cpu->sram) != 0)
+		return NULL;
+	sram = (Sram*)calloc(1, sizeof(Sram));
+	if (!sram)
+		return NULL;
+
+	// New save files start zeroed, like cartridge RAM after vm_LoadRom
+	fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0 || fstat(fd, &st) != 0 || ((size_t)st.st_size < size && ftruncate(fd, size) != 0)){
+		if (fd >= 0)
+			close(fd);
+		free(sram);
+		return NULL;
+	}
+
+	sram->cpu = pVm->cpu;
+	sram->fd = fd;
+	sram->data = data;
+	sram->size = size;
+	sram->interval_ms = interval_ms ? interval_ms : SRAM_INTERVAL_MS;
+	pthread_mutex_init(&sram->lock, NULL);
+	pthread_cond_init(&sram->wake, NULL);
+	if (pthread_create(&sram->thread, NULL, sram_Thread, sram) != 0){
+		sram_Release(sram);
+		return NULL;
+	}
+	// Replaces the arena pages in place, pointers to them stay valid
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED || sram_Move(map, data, size) != 0){
+		sram_Stop(sram);
+		sram_Release(sram);
+		return NULL;
+	}
+	// RAM now holds the file, changed outside of the write path
+	if (pVm->cpu->blocks)
+		block_FlushRam(pVm->cpu->blocks);
+	if (pVm->cpu->snap)
+		snap_Invalidate(pVm->cpu->snap);
+	pVm->cpu->sram = sram;
+	return sram;
+}
+
+void sram_Flush(Sram *pSram){
+	pthread_mutex_lock(&pSram->lock);
+	pSram->pending = 1;
+	pthread_cond_signal(&pSram->wake);
+	pthread_mutex_unlock(&pSram->lock);
+	return;
+}
+
+int8_t sram_Close(Sram *pSram){
+	// Flushed while the file is still mapped
+	msync(pSram->data, pSram->size, MS_SYNC);
+	if (sram_Detach(pSram) != 0)
+		return -1;
+	sram_Stop(pSram);
+	sram_Release(pSram);
+	return 0;
+}
+
+void sram_Free(Sram *pSram){
+	sram_Stop(pSram);
+	sram_Release(pSram);
+	return;
+}
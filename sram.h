@@ -0,0 +1,67 @@
+#ifndef _SRAM_H
+#define _SRAM_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "vm.h"
+
+/*
+
+	Battery backed cartridge RAM
+
+	The save file is mapped shared over the cartridge RAM of the VM
+	arena, in place: the mapper, save states, snapshots and rewind keep
+	using the same bytes and every guest write lands in the page cache
+	without a copy or a system call. A process crash loses nothing, the
+	kernel writes the pages back on its own.
+
+	The file is the cartridge RAM, whoever writes it: loading a save
+	state, restoring a snapshot and stepping back in the rewind buffer
+	write their cartridge RAM into the save file too, as the game would
+	find it on the cartridge. Close the save file first to explore states
+	without touching it.
+
+	A flush thread calls msync every interval and when the game disables
+	cartridge RAM, its usual sign of a finished save. The emulation
+	thread only sets a flag under a lock that is never held across disk
+	I/O, it does not wait on the disk.
+
+	Mappings replace each other with mremap, in one step: if the RAM can
+	not be copied back to anonymous pages on close, the file stays mapped
+	and attached rather than losing the RAM or writes to it.
+
+	Needs a page aligned arena, not available on reserved huge pages.
+
+*/
+
+#define SRAM_INTERVAL_MS (1000) // default flush interval
+
+// Save file structure
+typedef struct Sram{
+	Cpu *cpu;
+	int fd; // save file, kept open for the final fsync
+	uint8_t *data; // arena cartridge RAM, mapped on the file
+	size_t size;
+	uint32_t interval_ms;
+	pthread_t thread;
+	pthread_mutex_t lock; // guards pending, quit and flushes, never held across msync
+	pthread_cond_t wake;
+	uint8_t pending; // flush asked by the mapper
+	uint8_t quit;
+	uint64_t flushes; // msync calls done
+}Sram;
+
+// Map a save file over the cartridge RAM of the loaded cartridge, created or extended to its size,
+// interval_ms 0 uses SRAM_INTERVAL_MS, returns NULL if the cartridge has no RAM or on failure
+Sram* sram_Open(VM *pVm, const char *path, uint32_t interval_ms);
+// Ask the flush thread for an msync, does not wait for it
+void sram_Flush(Sram *pSram);
+// Write the file back, stop the flush thread and free, the RAM content stays in the arena,
+// returns 0 on success, -1 if the RAM could not be detached from the file: still mapped, flushed and attached
+int8_t sram_Close(Sram *pSram);
+// Stop the flush thread, write the file back and free, the file stays mapped until the arena is unmapped (vm_Quit)
+void sram_Free(Sram *pSram);
+
+#endif
@@ -0,0 +1,80 @@
+#include "timer.h"
+
+// TIMA period in clock cycles for each TAC clock select
+static const uint16_t timer_period[4] = {1024, 16, 64, 256};
+
+static inline uint16_t timer_Period(const Cpu *pCpu){
+	return timer_period[pCpu->sfr->TAC & TIMER_TAC_CLOCK];
+}
+
+// Returns TIMA at clock cycle now
+static uint8_t timer_Tima(const Cpu *pCpu, uint64_t now){
+	uint16_t period = timer_Period(pCpu);
+	uint8_t tma = pCpu->sfr->TMA;
+	uint64_t count;
+
+	if (!(pCpu->sfr->TAC & TIMER_TAC_ENABLE))
+		return pCpu->tima;
+	count = pCpu->tima + (now - pCpu->div_base) / period - (pCpu->tima_base - pCpu->div_base) / period;
+	if (count > 0xFF) // overflow event not fired yet
+		count = tma + (count - 0x100) % (0x100 - tma);
+	return count;
+}
+
+// Bring TIMA up to the current clock cycle
+static void timer_Update(Cpu *pCpu){
+	pCpu->tima = timer_Tima(pCpu, pCpu->clock_cycle);
+	pCpu->tima_base = pCpu->clock_cycle;
+	return;
+}
+
+// Schedule TIMA overflow from tima_base
+static void timer_Schedule(Cpu *pCpu){
+	uint16_t period = timer_Period(pCpu);
+	uint64_t ticks;
+
+	if (!(pCpu->sfr->TAC & TIMER_TAC_ENABLE)){
+		sched_Remove(&pCpu->sched, SCHED_EVENT_TIMER);
+		return;
+	}
+	// Overflow on the (0x100 - TIMA)th period boundary after tima_base
+	ticks = (pCpu->tima_base - pCpu->div_base) / period + (0x100 - pCpu->tima);
+	sched_Add(&pCpu->sched, SCHED_EVENT_TIMER, pCpu->div_base + ticks * period);
+	return;
+}
+
+void timer_Read(Cpu *pCpu){
+	pCpu->sfr->DIV = (pCpu->clock_cycle - pCpu->div_base) / TIMER_DIV_CYCLES;
+	pCpu->sfr->TIMA = timer_Tima(pCpu, pCpu->clock_cycle);
+	return;
+}
+
+void timer_Write(Cpu *pCpu, uint8_t data){
+	timer_Update(pCpu);
+	switch (pCpu->address_bus){
+		case MEM_DIV_REG_OFFSET: // any write resets DIV
+			pCpu->div_base = pCpu->clock_cycle;
+			pCpu->sfr->DIV = 0;
+			break;
+		case MEM_TIMA_REG_OFFSET:
+			pCpu->tima = data;
+			pCpu->sfr->TIMA = data;
+			break;
+		case MEM_TMA_REG_OFFSET:
+			pCpu->sfr->TMA = data;
+			break;
+		case MEM_TAC_REG_OFFSET:
+			pCpu->sfr->TAC = data;
+			break;
+	}
+	timer_Schedule(pCpu);
+	return;
+}
+
+void timer_Event(Cpu *pCpu, uint64_t deadline){
+	pCpu->tima = pCpu->sfr->TMA;
+	pCpu->tima_base = deadline;
+	pCpu->sfr->IF_bits.timer_overflow = 1;
+	timer_Schedule(pCpu);
+	return;
+}
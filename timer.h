@@ -0,0 +1,33 @@
+#ifndef _TIMER_H
+#define _TIMER_H
+
+#include "cpu.h"
+
+/*
+
+	Timer
+
+	Nothing ticks per instruction. DIV and TIMA are derived from
+	clock_cycle when they are read: DIV counts clock cycles since its last
+	reset / 256, TIMA counts the TAC periods elapsed since it was last
+	written or reloaded. TIMA increments on multiples of its period since
+	the DIV reset, like the hardware counter they share.
+
+	TIMA overflow is a single SCHED_EVENT_TIMER event, its deadline is
+	recomputed when DIV, TIMA, TMA or TAC are written. The event reloads
+	TMA and requests the timer interrupt.
+
+*/
+
+#define TIMER_DIV_CYCLES (256) // DIV increments at 16384Hz
+#define TIMER_TAC_ENABLE (0x04)
+#define TIMER_TAC_CLOCK (0x03)
+
+// Refresh DIV and TIMA in memory, called when they are read
+void timer_Read(Cpu *pCpu);
+// Write to DIV, TIMA, TMA or TAC at address_bus
+void timer_Write(Cpu *pCpu, uint8_t data);
+// SCHED_EVENT_TIMER handler, TIMA overflow
+void timer_Event(Cpu *pCpu, uint64_t deadline);
+
+#endif
@@ -0,0 +1,131 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../alu.h"
+
+/*
+	Check the ALU tables built by alu_Init against a reference model
+
+	Additions and subtractions are done one bit at a time, H and C are the
+	carries / borrows out of bit 3 and bit 7. DAA is checked against
+	decimal arithmetic on every BCD operand pair, and against the
+	correction formula for every input.
+
+	Usage: alu_check
+	Build: gcc -O2 -o alu_check tools/alu_check.c alu.c
+*/
+
+static uint32_t errors = 0;
+
+static void check(const char *name, uint32_t input, uint16_t got, uint16_t expected){
+	if (got == expected)
+		return;
+	if (errors < 16)
+		printf("%s %05X: got %04X expected %04X\n", name, input, got, expected);
+	errors++;
+	return;
+}
+
+// Ripple carry adder, returns AF
+static uint16_t ref_Add(uint8_t a, uint8_t b, uint8_t carry){
+	uint8_t res = 0, f = 0, i, x, y;
+
+	for (i = 0; i < 8; i++){
+		x = (a >> i) & 1;
+		y = (b >> i) & 1;
+		res |= (x ^ y ^ carry) << i;
+		carry = (x & y) | (carry & (x ^ y));
+		if (i == 3 && carry)
+			f |= ALU_FLAG_H;
+	}
+	if (carry)
+		f |= ALU_FLAG_C;
+	if (res == 0)
+		f |= ALU_FLAG_Z;
+	return res << 8 | f;
+}
+
+// Ripple borrow subtractor, returns AF
+static uint16_t ref_Sub(uint8_t a, uint8_t b, uint8_t borrow){
+	uint8_t res = 0, f = ALU_FLAG_N, i, x, y;
+
+	for (i = 0; i < 8; i++){
+		x = (a >> i) & 1;
+		y = (b >> i) & 1;
+		res |= (x ^ y ^ borrow) << i;
+		borrow = ((x ^ 1) & y) | (borrow & (x ^ y ^ 1));
+		if (i == 3 && borrow)
+			f |= ALU_FLAG_H;
+	}
+	if (borrow)
+		f |= ALU_FLAG_C;
+	if (res == 0)
+		f |= ALU_FLAG_Z;
+	return res << 8 | f;
+}
+
+// DAA as a single correction added or subtracted, returns AF
+static uint16_t ref_Daa(uint8_t a, uint8_t f){
+	uint8_t correction = 0, c = 0;
+
+	if ((f & ALU_FLAG_H) || (!(f & ALU_FLAG_N) && (a & 0x0F) > 0x09))
+		correction |= 0x06;
+	if ((f & ALU_FLAG_C) || (!(f & ALU_FLAG_N) && a > 0x99)){
+		correction |= 0x60;
+		c = ALU_FLAG_C;
+	}
+	a = (f & ALU_FLAG_N) ? a - correction : a + correction;
+	return a << 8 | (a ? 0 : ALU_FLAG_Z) | (f & ALU_FLAG_N) | c;
+}
+
+static uint8_t bcd(uint8_t value){
+	return (value / 10) << 4 | value % 10;
+}
+
+int main(int argc, char *argv[]){
+	uint32_t a, b, carry, i;
+	uint16_t af, expected;
+	int diff;
+
+	alu_Init();
+
+	for (carry = 0; carry < 2; carry++){
+		for (a = 0; a < 0x100; a++){
+			for (b = 0; b < 0x100; b++){
+				check("ADC", carry << 16 | a << 8 | b, alu_add[carry][a][b], ref_Add(a, b, carry));
+				check("SBC", carry << 16 | a << 8 | b, alu_sub[carry][a][b], ref_Sub(a, b, carry));
+			}
+		}
+	}
+	for (a = 0; a < 0x100; a++){
+		check("INC", a, alu_inc[a], ref_Add(a, 1, 0) & (ALU_FLAG_Z | ALU_FLAG_H));
+		check("DEC", a, alu_dec[a], ref_Sub(a, 1, 0) & (ALU_FLAG_Z | ALU_FLAG_N | ALU_FLAG_H));
+		check("ZERO", a, alu_zero[a], a ? 0 : ALU_FLAG_Z);
+	}
+	for (i = 0; i < ALU_DAA_SIZE; i++){
+		af = (i & 0xFF) << 8 | ((i >> 4) & (ALU_FLAG_N | ALU_FLAG_H | ALU_FLAG_C));
+		check("DAA", i, alu_daa[ALU_DAA_INDEX(af)], ref_Daa(af >> 8, af & 0xFF));
+	}
+
+	// Decimal arithmetic: ADC / SBC of BCD operands followed by DAA
+	for (carry = 0; carry < 2; carry++){
+		for (a = 0; a < 100; a++){
+			for (b = 0; b < 100; b++){
+				af = alu_daa[ALU_DAA_INDEX(alu_add[carry][bcd(a)][bcd(b)])];
+				expected = bcd((a + b + carry) % 100) << 8 | (a + b + carry > 99 ? ALU_FLAG_C : 0);
+				check("BCD ADD", carry << 16 | a << 8 | b, af & 0xFF50, expected);
+				diff = (int)a - (int)b - (int)carry;
+				af = alu_daa[ALU_DAA_INDEX(alu_sub[carry][bcd(a)][bcd(b)])];
+				expected = bcd((diff + 100) % 100) << 8 | ALU_FLAG_N | (diff < 0 ? ALU_FLAG_C : 0);
+				check("BCD SUB", carry << 16 | a << 8 | b, af & 0xFF50, expected);
+			}
+		}
+	}
+
+	if (errors){
+		printf("%u errors\n", errors);
+		return 1;
+	}
+	printf("ALU tables ok\n");
+	return 0;
+}
@@ -0,0 +1,164 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../vm.h"
+#include "../jit.h"
+#include "../serial.h"
+#include "../opcode.h"
+
+/*
+	Differential test of the recompiler against the interpreter
+
+	Each seed fills ROM, VRAM and internal RAM with random bytes and runs
+	them from $0100 on two VMs: one interprets every instruction, the
+	other compiles every block on its first run in verify mode. Random
+	bytes seldom run a block twice, every other seed turns $0100 into a
+	loop of random instructions without control flow, its block runs
+	native on every iteration. Every
+	native block is checked against the interpreter from the same state
+	(cpu_JitVerify), and after every slice of clock cycles both VMs must
+	hold the same registers, memory and serial output: verifying must not
+	apply a memory write or an IO side effect twice.
+
+	Usage: jit_check [seeds] [slices]
+	Build: gcc -O2 -pthread -o jit_check tools/jit_check.c $CORE
+*/
+
+#define CHECK_SERIAL_SIZE (0x1000)
+#define CHECK_LOOP_MAX (96) // loop body bytes, JR reaches back 126 bytes
+
+static uint32_t rng;
+
+// xorshift32, the same programs on every host
+static uint32_t check_Rand(void){
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng;
+}
+
+// Random instructions at $0100, control flow replaced by NOP, then JR back to $0100
+static void check_Loop(uint8_t *pRom){
+	uint16_t size = 8 + check_Rand() % (CHECK_LOOP_MAX - 8), pc = 0x100, idx;
+	const Cpu_Opcode *op;
+
+	while (pc < 0x100 + size){
+		idx = pRom[pc] == OPCODE_EXTENDED ? CPU_PAGE1 | pRom[pc + 1] : pRom[pc];
+		op = cpu_GetOpcode(idx);
+		if (op->block_end || pc + op->size > 0x100 + size){
+			pRom[pc++] = 0x00;
+			continue;
+		}
+		pc += op->size;
+	}
+	pRom[pc] = 0x18;
+	pRom[pc + 1] = (uint8_t)(0x100 - (pc + 2));
+	return;
+}
+
+static VM* check_Vm(uint32_t seed){
+	VM *vm = vm_Init(0);
+	uint32_t i;
+
+	if (!vm)
+		return NULL;
+	rng = seed * 2654435761u + 1;
+	for (i = 0; i < ROM_SIZE; i++)
+		vm->ROM->data[i] = check_Rand();
+	if (seed & 2)
+		check_Loop(vm->ROM->data);
+	for (i = 0; i < MEM_VIDEO_RAM_SIZE; i++)
+		vm->VRAM->data[i] = check_Rand();
+	// IO ports and HRAM left zeroed, interrupts and the LCD as after reset
+	for (i = 0; i < MEM_RAM_INTERNAL_SIZE_TOTAL - MEM_PAGE_SIZE; i++)
+		vm->Internal_RAM->data[i] = (seed & 1) ? check_Rand() : 0;
+	vm->cpu->sfr->BIOS = 1;
+	cpu_UpdatePageTable(vm->cpu);
+	vm->cpu->PC = 0x100;
+	vm->cpu->SP = 0xDFF0;
+	vm->cpu->AF = check_Rand();
+	vm->cpu->BC = check_Rand();
+	vm->cpu->DE = check_Rand();
+	vm->cpu->HL = MEM_RAM_INTERNAL_OFFSET | (check_Rand() & 0x1FFF);
+	vm->cpu->serial_out = serial_OutInit(CHECK_SERIAL_SIZE);
+	return vm;
+}
+
+static uint32_t check_Hash(const VM *pVm){
+	uint32_t hash = 0, i;
+
+	for (i = 0; i < MEM_RAM_INTERNAL_SIZE_TOTAL; i++)
+		hash = hash * 31 + pVm->Internal_RAM->data[i];
+	for (i = 0; i < MEM_VIDEO_RAM_SIZE; i++)
+		hash = hash * 31 + pVm->VRAM->data[i];
+	for (i = 0; i < pVm->RAM->size; i++)
+		hash = hash * 31 + pVm->RAM->data[i];
+	return hash;
+}
+
+// Returns 1 if both VMs are in the same state
+static uint8_t check_Same(const VM *a, const VM *b){
+	const Cpu *x = a->cpu, *y = b->cpu;
+
+	return x->PC == y->PC && x->SP == y->SP && x->AF == y->AF && x->BC == y->BC
+		&& x->DE == y->DE && x->HL == y->HL && x->clock_cycle == y->clock_cycle
+		&& x->serial_out->count == y->serial_out->count
+		&& !memcmp(x->serial_out->data, y->serial_out->data, x->serial_out->count)
+		&& check_Hash(a) == check_Hash(b);
+}
+
+int main(int argc, char *argv[]){
+	uint32_t seeds = argc > 1 ? strtoul(argv[1], NULL, 0) : 32;
+	uint32_t slices = argc > 2 ? strtoul(argv[2], NULL, 0) : 1000;
+	uint64_t compiled = 0, verified = 0, mismatches = 0;
+	uint32_t seed, i, budget, diverged = 0;
+	VM *ref, *vm;
+
+	for (seed = 1; seed <= seeds; seed++){
+		ref = check_Vm(seed);
+		vm = check_Vm(seed);
+		if (!ref || !vm || !ref->cpu->serial_out || !vm->cpu->serial_out){
+			printf("Out of memory\n");
+			return 1;
+		}
+		block_Free(ref->cpu->blocks);
+		ref->cpu->blocks = NULL;
+		idle_Free(ref->cpu->idle);
+		ref->cpu->idle = NULL;
+		idle_Free(vm->cpu->idle);
+		vm->cpu->idle = NULL;
+		vm->cpu->jit = jit_Init(1);
+		if (!vm->cpu->jit){
+			printf("Jit not available on this host\n");
+			return 1;
+		}
+		vm->cpu->jit->threshold = 1;
+
+		for (i = 0; i < slices; i++){
+			// Random programs halt and stop often, wake them the same way
+			ref->cpu->halt = vm->cpu->halt = 0;
+			ref->cpu->stop = vm->cpu->stop = 0;
+			budget = 1 + check_Rand() % 300;
+			cpu_RunCycles(ref->cpu, budget);
+			cpu_RunCycles(vm->cpu, budget);
+			if (!check_Same(ref, vm)){
+				printf("seed %u: verified run diverged at slice %u, PC %04X/%04X\n", seed, i, ref->cpu->PC, vm->cpu->PC);
+				diverged++;
+				break;
+			}
+		}
+		compiled += vm->cpu->jit->compiled;
+		verified += vm->cpu->jit->verified;
+		mismatches += vm->cpu->jit->mismatches;
+		jit_Free(vm->cpu->jit);
+		vm->cpu->jit = NULL;
+		vm_Quit(ref);
+		vm_Quit(vm);
+	}
+
+	printf("%u seeds: %llu blocks compiled, %llu verified, %llu mismatches, %u diverged\n", seeds,
+		(unsigned long long)compiled, (unsigned long long)verified, (unsigned long long)mismatches, diverged);
+	return mismatches || diverged ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../opcode.h"
+#include "../trace.h"
+
+/*
+	Decode a binary execution trace written by the Cpu (see trace.h)
+
+	Usage: trace_decode <trace file> [last n records]
+	Build: gcc -O2 -o trace_decode tools/trace_decode.c opcode.c
+*/
+
+// Flags in F register
+#define FLAG_Z (0x80)
+#define FLAG_N (0x40)
+#define FLAG_H (0x20)
+#define FLAG_C (0x10)
+
+static void trace_Print(const Trace_Record *pRec){
+	const Opcode *op;
+	uint8_t A = pRec->AF >> 8, F = pRec->AF & 0xFF;
+
+	printf("%10llu $%04X> ", (unsigned long long)pRec->clock_cycle, pRec->PC);
+	if (pRec->opcode & 0x100){
+		op = &page1[pRec->opcode & 0xFF];
+		printf("CB %02X\t", pRec->opcode & 0xFF);
+	}else{
+		op = &page0[pRec->opcode & 0xFF];
+		printf("%02X\t", pRec->opcode & 0xFF);
+	}
+	printf(op->mnemonic, pRec->operand);
+	printf("\t\t");
+	printf(op->description, pRec->operand);
+	printf("\t");
+
+	printf("%02X | %02X | %02X | %02X |", A, pRec->BC >> 8, pRec->BC & 0xFF, pRec->DE >> 8);
+	printf("%02X | %02X | %02X | ", pRec->DE & 0xFF, pRec->HL >> 8, pRec->HL & 0xFF);
+	printf("SP %04X | ", pRec->SP);
+	printf("%c%c", F & FLAG_C ? 'C': 'c', F & FLAG_H ? 'H': 'h');
+	printf("%c%c", F & FLAG_N ? 'N': 'n', F & FLAG_Z ? 'Z': 'z');
+	printf("\n");
+	return;
+}
+
+int main(int argc, char *argv[]){
+	FILE *f = NULL;
+	Trace_Header header;
+	Trace_Record *records = NULL;
+	uint64_t start, last, i;
+
+	if (argc < 2){
+		printf("Usage: %s <trace file> [last n records]\n", argv[0]);
+		return -1;
+	}
+
+	f = fopen(argv[1], "rb");
+	if (!f){
+		printf("Could not open %s\n", argv[1]);
+		return -1;
+	}
+	if (fread(&header, sizeof(Trace_Header), 1, f) != 1
+		|| memcmp(header.magic, TRACE_MAGIC, 4) != 0
+		|| header.version != TRACE_VERSION
+		|| header.record_size != sizeof(Trace_Record)
+		|| header.capacity == 0 || (header.capacity & (header.capacity - 1))){
+		printf("%s is not a trace file\n", argv[1]);
+		fclose(f);
+		return -1;
+	}
+
+	records = (Trace_Record*)malloc(sizeof(Trace_Record) * header.capacity);
+	if (!records || fread(records, sizeof(Trace_Record), header.capacity, f) != header.capacity){
+		printf("Truncated trace file %s\n", argv[1]);
+		free(records);
+		fclose(f);
+		return -1;
+	}
+	fclose(f);
+
+	// Oldest record still in the ring
+	start = header.count > header.capacity ? header.count - header.capacity : 0;
+	if (argc > 2){
+		last = strtoull(argv[2], NULL, 0);
+		if (header.count - start > last)
+			start = header.count - last;
+	}
+	for (i = start; i < header.count; i++)
+		trace_Print(&records[i & (header.capacity - 1)]);
+
+	free(records);
+	return 0;
+}
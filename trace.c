@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include "trace.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define TRACE_MMAP
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+// Round capacity up to a power of 2
+static uint32_t trace_Capacity(uint32_t capacity){
+	uint32_t size = 1;
+	while (size < capacity && size < 0x80000000)
+		size <<= 1;
+	return size;
+}
+
+static void trace_SetHeader(Trace_Header *pHeader, uint32_t capacity){
+	memcpy(pHeader->magic, TRACE_MAGIC, 4);
+	pHeader->version = TRACE_VERSION;
+	pHeader->record_size = sizeof(Trace_Record);
+	pHeader->capacity = capacity;
+	pHeader->reserved = 0;
+	pHeader->count = 0;
+	return;
+}
+
+Trace* trace_Init(uint32_t capacity){
+	Trace *trace = NULL;
+
+	trace = (Trace*)calloc(1, sizeof(Trace));
+	if (!trace)
+		return NULL;
+	capacity = trace_Capacity(capacity);
+	trace->header = (Trace_Header*)malloc(sizeof(Trace_Header));
+	trace->records = (Trace_Record*)malloc(sizeof(Trace_Record) * capacity);
+	if (!trace->header || !trace->records){
+		trace_Free(trace);
+		return NULL;
+	}
+	trace_SetHeader(trace->header, capacity);
+	trace->mask = capacity - 1;
+	return trace;
+}
+
+Trace* trace_Open(const char *path, uint32_t capacity){
+#if defined(TRACE_MMAP)
+	Trace *trace = NULL;
+	size_t size;
+	void *map;
+	int fd;
+
+	capacity = trace_Capacity(capacity);
+	size = sizeof(Trace_Header) + sizeof(Trace_Record) * capacity;
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return NULL;
+	if (ftruncate(fd, size) != 0){
+		close(fd);
+		return NULL;
+	}
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return NULL;
+
+	trace = (Trace*)calloc(1, sizeof(Trace));
+	if (!trace){
+		munmap(map, size);
+		return NULL;
+	}
+	trace->map = map;
+	trace->map_size = size;
+	trace->header = (Trace_Header*)map;
+	trace->records = (Trace_Record*)((uint8_t*)map + sizeof(Trace_Header));
+	trace->mask = capacity - 1;
+	trace_SetHeader(trace->header, capacity);
+	return trace;
+#else
+	// No file mapping, keep trace in memory and write it on trace_Free
+	Trace *trace = trace_Init(capacity);
+	if (!trace)
+		return NULL;
+	trace->path = (char*)malloc(strlen(path) + 1);
+	if (!trace->path){
+		trace_Free(trace);
+		return NULL;
+	}
+	strcpy(trace->path, path);
+	return trace;
+#endif
+}
+
+int8_t trace_Save(Trace *pTrace, const char *path){
+	FILE *f = NULL;
+	size_t records = pTrace->header->capacity;
+
+	f = fopen(path, "wb");
+	if (!f)
+		return -1;
+	if (fwrite(pTrace->header, sizeof(Trace_Header), 1, f) != 1
+		|| fwrite(pTrace->records, sizeof(Trace_Record), records, f) != records){
+		fclose(f);
+		return -2;
+	}
+	fclose(f);
+	return 0;
+}
+
+void trace_Free(Trace *pTrace){
+	if (pTrace->map){
+#if defined(TRACE_MMAP)
+		munmap(pTrace->map, pTrace->map_size);
+#endif
+	}else{
+		if (pTrace->path && pTrace->header && pTrace->records)
+			trace_Save(pTrace, pTrace->path);
+		free(pTrace->header);
+		free(pTrace->records);
+	}
+	free(pTrace->path);
+	free(pTrace);
+	return;
+}
@@ -0,0 +1,71 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+
+	Execution trace
+
+	Fixed size binary records appended to a ring buffer, either in memory
+	or mapped on a file. Records are written by the Cpu after every
+	instruction while a trace is attached, tools/trace_decode.c renders
+	them as text.
+
+	File layout: Trace_Header followed by capacity Trace_Record.
+
+*/
+
+#define TRACE_MAGIC "DGTR"
+#define TRACE_VERSION (1)
+
+// Trace file header
+typedef struct{
+	char magic[4];
+	uint16_t version;
+	uint16_t record_size; // sizeof(Trace_Record)
+	uint32_t capacity; // number of records in ring, power of 2
+	uint32_t reserved;
+	uint64_t count; // number of records written since start
+}Trace_Header;
+
+// Trace record, one per instruction
+typedef struct{
+	uint64_t clock_cycle; // clock cycle after execution
+	uint16_t PC; // address of executed instruction
+	uint16_t opcode; // page1 opcodes are offset by 0x100
+	uint16_t operand; // immediate operand
+	uint16_t AF; // registers after execution
+	uint16_t BC;
+	uint16_t DE;
+	uint16_t HL;
+	uint16_t SP;
+}Trace_Record;
+
+// Trace structure
+typedef struct{
+	Trace_Header *header; // points into map when backed by a file
+	Trace_Record *records;
+	uint32_t mask; // capacity - 1
+	void *map; // file mapping, NULL for memory traces
+	size_t map_size;
+	char *path; // file written by trace_Free when the file could not be mapped
+}Trace;
+
+// Initialize and return an in memory trace of at least capacity records
+Trace* trace_Init(uint32_t capacity);
+// Initialize and return a trace mapped on a file
+Trace* trace_Open(const char *path, uint32_t capacity);
+// Write trace to a file
+int8_t trace_Save(Trace *pTrace, const char *path);
+// Free a trace, flushes file backed traces
+void trace_Free(Trace *pTrace);
+
+// Returns next record to fill, overwrites oldest record when the ring is full
+static inline Trace_Record* trace_Next(Trace *pTrace){
+	return &pTrace->records[pTrace->header->count++ & pTrace->mask];
+}
+
+#endif
@@ -1,7 +1,99 @@
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "vm.h"
+#include "snap.h"
+#include "mbc.h"
+#include "sram.h"
+
+// Map a zeroed arena, huge pages first when asked, returns NULL on failure
+// Always mapped, never on the heap: unmapping it also drops a save file mapped over its cartridge RAM
+static VM_Arena* vm_AllocArena(VM *pVm, uint8_t flags){
+	uint8_t *arena = NULL, *map;
+	size_t size = (sizeof(VM_Arena) + VM_ARENA_ALIGN - 1) / VM_ARENA_ALIGN * VM_ARENA_ALIGN;
+	size_t huge = (sizeof(VM_Arena) + VM_HUGE_PAGE_SIZE - 1) / VM_HUGE_PAGE_SIZE * VM_HUGE_PAGE_SIZE;
+	size_t head;
+
+	pVm->arena_huge = 0;
+	if (flags & VM_INIT_HUGE_PAGES){
+#if defined(MAP_HUGETLB)
+		// Reserved huge pages
+		map = (uint8_t*)mmap(NULL, huge, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (map != MAP_FAILED){
+			pVm->arena_size = huge;
+			pVm->arena_huge = 1;
+			return (VM_Arena*)map;
+		}
+#endif
+		// None reserved, aligned for a transparent huge page: one more huge page mapped, the ends trimmed
+		map = (uint8_t*)mmap(NULL, huge + VM_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (map != MAP_FAILED){
+			head = (VM_HUGE_PAGE_SIZE - (uintptr_t)map % VM_HUGE_PAGE_SIZE) % VM_HUGE_PAGE_SIZE;
+			if (head)
+				munmap(map, head);
+			munmap(map + head + huge, VM_HUGE_PAGE_SIZE - head);
+			arena = map + head;
+#if defined(MADV_HUGEPAGE)
+			madvise(arena, huge, MADV_HUGEPAGE);
+#endif
+			size = huge;
+		}
+	}
+	if (!arena){
+		map = (uint8_t*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (map == MAP_FAILED)
+			return NULL;
+		arena = map;
+	}
+	// Anonymous pages are zeroed, runs are reproducible
+	pVm->arena_size = size;
+	return (VM_Arena*)arena;
+}
 
-VM* vm_Init(void){
+static void vm_FreeArena(VM *pVm){
+	munmap(pVm->arena, pVm->arena_size);
+	return;
+}
+
+// Arena offset of the data of each RAM memory map, ROM and BIOS maps follow their Memory
+static const size_t vm_map_data[MEM_ADDRESS_SPACES] = {
+	[MAP_VRAM] = offsetof(VM_Arena, vram),
+	[MAP_RAM_BANK_SWITCH] = offsetof(VM_Arena, ram),
+	[MAP_RAM_INTERNAL] = offsetof(VM_Arena, internal_ram),
+	[MAP_RAM_INTERNAL_ECHO] = offsetof(VM_Arena, internal_ram), // echo of $C000 - $DDFF
+	[MAP_OAM] = offsetof(VM_Arena, internal_ram) + MEM_SPRITE_ATTRI_OFFSET - MEM_RAM_INTERNAL_OFFSET,
+	[MAP_HRAM] = offsetof(VM_Arena, internal_ram) + MEM_HRAM_OFFSET - MEM_RAM_INTERNAL_OFFSET,
+	[MAP_IO_PORTS] = offsetof(VM_Arena, internal_ram) + MEM_IO_PORTS_OFFSET - MEM_RAM_INTERNAL_OFFSET,
+};
+
+// Derive every pointer into the arena from its layout, after vm_Init or a state load
+static void vm_SetPointers(VM *pVm){
+	VM_Arena *arena = pVm->arena;
+	Cpu *cpu = &arena->cpu;
+	uint8_t i;
+
+	arena->BIOS.data = pVm->bios_file ? pVm->bios_file : arena->bios;
+	arena->ROM.data = pVm->rom_file ? pVm->rom_file : arena->rom;
+	arena->VRAM.data = arena->vram;
+	arena->RAM.data = arena->ram;
+	arena->Internal_RAM.data = arena->internal_ram;
+	for (i = 0; i < MEM_ADDRESS_SPACES; i++)
+		arena->map[i].mem.data = (uint8_t*)arena + vm_map_data[i];
+	arena->map[MAP_ROM_BIOS].mem.data = arena->BIOS.data;
+	arena->map[MAP_ROM_BANK_0].mem.data = arena->ROM.data;
+	arena->map[MAP_ROM_BANK_SWITCH].mem.data = arena->ROM.data;
+	cpu->map = arena->map;
+	cpu_SetSpecialRegisters(cpu, &arena->internal_ram[MEM_IO_PORTS_OFFSET - MEM_RAM_INTERNAL_OFFSET]);
+	cpu_SetInterruptEnableRegister(cpu, &arena->internal_ram[MEM_IE_REG_OFFSET - MEM_RAM_INTERNAL_OFFSET]);
+	return;
+}
+
+VM* vm_Init(uint8_t flags){
 	VM *vm = NULL;
+	VM_Arena *arena = NULL;
 	Cpu *cpu = NULL;
 	Memory *BIOS = NULL;
 	Memory *ROM = NULL;
@@ -12,15 +104,31 @@ VM* vm_Init(void){
 	vm = (VM*)malloc(sizeof(VM));
 	if (!vm)
 		return NULL;
+	arena = vm_AllocArena(vm, flags);
+	if (!arena){
+		free(vm);
+		return NULL;
+	}
+	vm->arena = arena;
+	vm->rom_file = NULL;
+	vm->rom_file_size = 0;
+	vm->bios_file = NULL;
+	vm->bios_file_size = 0;
 
-	BIOS = mem_Init(MEM_ROM_BIOS_SIZE, 1, MEM_ROM_BIOS_SIZE);
-	ROM = mem_Init(ROM_SIZE, ROM_BANK_SIZE, ROM_SIZE / ROM_BANK_SIZE);
-	VRAM = mem_Init(MEM_VIDEO_RAM_SIZE, 1, MEM_VIDEO_RAM_SIZE);
-	RAM = mem_Init(RAM_SIZE, RAM_BANK_SIZE, RAM_SIZE / RAM_BANK_SIZE);
-	Internal_RAM = mem_Init(MEM_RAM_INTERNAL_SIZE_TOTAL, 1, MEM_RAM_INTERNAL_SIZE_TOTAL);
+	BIOS = &arena->BIOS;
+	ROM = &arena->ROM;
+	VRAM = &arena->VRAM;
+	RAM = &arena->RAM;
+	Internal_RAM = &arena->Internal_RAM;
+	mem_Setup(BIOS, arena->bios, MEM_ROM_BIOS_SIZE, 1, MEM_ROM_BIOS_SIZE);
+	mem_Setup(ROM, arena->rom, ROM_SIZE, ROM_SIZE / ROM_BANK_SIZE, ROM_BANK_SIZE);
+	mem_Setup(VRAM, arena->vram, MEM_VIDEO_RAM_SIZE, 1, MEM_VIDEO_RAM_SIZE);
+	mem_Setup(RAM, arena->ram, RAM_SIZE, RAM_SIZE / RAM_BANK_SIZE, RAM_BANK_SIZE);
+	mem_Setup(Internal_RAM, arena->internal_ram, MEM_RAM_INTERNAL_SIZE_TOTAL, 1, MEM_RAM_INTERNAL_SIZE_TOTAL);
 
 	// Init CPU
-	cpu = cpu_Init();
+	cpu = &arena->cpu;
+	cpu_Setup(cpu, arena->map);
 
 	// set up BIOS
 	mem_CopyInfo(&cpu->map[MAP_ROM_BIOS].mem, BIOS);
@@ -44,7 +152,6 @@ VM* vm_Init(void){
 	cpu->map[MAP_RAM_BANK_SWITCH].offset = MEM_RAM_SWITCH_OFFSET;
 
 	// set up internal RAM $C000 - $DFFF
-	cpu->map[MAP_RAM_INTERNAL].mem.data = Internal_RAM->data;
 	cpu->map[MAP_RAM_INTERNAL].mem.banks = 1;
 	cpu->map[MAP_RAM_INTERNAL].mem.size = RAM_BANK_SIZE;
 	cpu->map[MAP_RAM_INTERNAL].mem.bank_size = RAM_BANK_SIZE;
@@ -52,7 +159,6 @@ VM* vm_Init(void){
 	cpu->map[MAP_RAM_INTERNAL].offset = MEM_RAM_INTERNAL_OFFSET;
 
 	// set up echo of internal RAM $E000 - $FDFF => points to $C000 - $DFFF
-	cpu->map[MAP_RAM_INTERNAL_ECHO].mem.data = Internal_RAM->data;
 	cpu->map[MAP_RAM_INTERNAL_ECHO].mem.banks = 1;
 	cpu->map[MAP_RAM_INTERNAL_ECHO].mem.size = MEM_RAM_INTERNAL_ECHO_SIZE;
 	cpu->map[MAP_RAM_INTERNAL_ECHO].mem.bank_size = MEM_RAM_INTERNAL_ECHO_SIZE;
@@ -60,7 +166,6 @@ VM* vm_Init(void){
 	cpu->map[MAP_RAM_INTERNAL_ECHO].offset = MEM_RAM_INTERNAL_ECHO_OFFSET;
 
 	// set up object attribute mem $FE00 - $FE9F
-	cpu->map[MAP_OAM].mem.data = &Internal_RAM->data[MEM_SPRITE_ATTRI_OFFSET - MEM_RAM_INTERNAL_OFFSET];
 	cpu->map[MAP_OAM].mem.banks = 1;
 	cpu->map[MAP_OAM].mem.size = MEM_SPRITE_ATTRI_SIZE;
 	cpu->map[MAP_OAM].mem.bank_size = MEM_SPRITE_ATTRI_SIZE;
@@ -68,7 +173,6 @@ VM* vm_Init(void){
 	cpu->map[MAP_OAM].offset = MEM_SPRITE_ATTRI_OFFSET;
 
 	// set up HRAM section of map $FF80 - $FFFE
-	cpu->map[MAP_HRAM].mem.data = &Internal_RAM->data[MEM_HRAM_OFFSET - MEM_RAM_INTERNAL_OFFSET];
 	cpu->map[MAP_HRAM].mem.banks = 1;
 	cpu->map[MAP_HRAM].mem.size = MEM_HRAM_SIZE;
 	cpu->map[MAP_HRAM].mem.bank_size = MEM_HRAM_SIZE;
@@ -76,28 +180,23 @@ VM* vm_Init(void){
 	cpu->map[MAP_HRAM].offset = MEM_HRAM_OFFSET;
 
 	// set up IO ports, including interrupt enable register $FF00 - $FFFF
-	cpu->map[MAP_IO_PORTS].mem.data = &Internal_RAM->data[MEM_IO_PORTS_OFFSET - MEM_RAM_INTERNAL_OFFSET];
 	cpu->map[MAP_IO_PORTS].mem.banks = 1;
 	cpu->map[MAP_IO_PORTS].mem.size = MEM_IO_PORTS_SIZE;
 	cpu->map[MAP_IO_PORTS].mem.bank_size = MEM_IO_PORTS_SIZE;
 	cpu->map[MAP_IO_PORTS].mem.start_idx = 0;
 	cpu->map[MAP_IO_PORTS].offset = MEM_IO_PORTS_OFFSET;
 
-    // Set SFR pointer
-	cpu_SetSpecialRegisters(cpu, cpu->map[MAP_IO_PORTS].mem.data);
+	// Memory data, SFR and IE pointers
+	vm_SetPointers(vm);
 	cpu->sfr->BIOS = 0;
-	// Set IE register
-	cpu_SetInterruptEnableRegister(cpu, &Internal_RAM->data[MEM_IE_REG_OFFSET - MEM_RAM_INTERNAL_OFFSET]);
-
-	// Do SDL stuff
-	if (SDL_Init(SDL_INIT_VIDEO) < 0)
-		return NULL;
-	vm->w = SDL_CreateWindow("DameGame", 100, 100, LCD_WIDTH, LCD_HEIGHT, SDL_WINDOW_SHOWN);
-	if (!vm->w)
-		return NULL;
-	vm->ws = SDL_GetWindowSurface(vm->w);
-	SDL_FillRect(vm->ws, &vm->ws->clip_rect, 0xFF77EE22);
-	SDL_UpdateWindowSurface(vm->w);
+	// Joypad lines, no button pressed
+	joypad_Update(cpu);
+	// Decoded block cache, NULL interprets every instruction
+	cpu->blocks = block_Init();
+	// Idle loop skipping, needs the block cache
+	cpu->idle = idle_Init();
+	// Build address decoding page table
+	cpu_UpdatePageTable(cpu);
 
 	// add all to VM
 	vm->BIOS = BIOS;
@@ -106,63 +205,332 @@ VM* vm_Init(void){
 	vm->RAM = RAM;
 	vm->Internal_RAM = Internal_RAM;
 	vm->cpu = cpu;
+	vm->keys = 0;
 
 	return vm;
 }
 
-int8_t vm_LoadBios(VM *pVm, char *path){
-	uint16_t fsize = 0, bsize = 0;
-	uint8_t *p;
-	FILE *bios = NULL;
-	bios = fopen(path, "rb");
-	if (!bios)
-		return -1;
-	for (fsize = 0; fgetc(bios) != EOF; fsize++);
-	rewind(bios);
+// Map the first size bytes of a file read only, shared with every process mapping it, returns NULL on failure
+static uint8_t* vm_MapFile(int fd, size_t size){
+	void *data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	return data == MAP_FAILED ? NULL : (uint8_t*)data;
+}
+
+static void vm_UnmapFiles(VM *pVm){
+	if (pVm->bios_file)
+		munmap(pVm->bios_file, pVm->bios_file_size);
+	if (pVm->rom_file)
+		munmap(pVm->rom_file, pVm->rom_file_size);
+	pVm->bios_file = NULL;
+	pVm->rom_file = NULL;
+	return;
+}
 
-	if (fsize != MEM_ROM_BIOS_SIZE){
-		fclose(bios);
+int8_t vm_LoadBios(VM *pVm, const char *path){
+	struct stat st;
+	uint8_t *data;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -1;
+	if (fstat(fd, &st) != 0 || st.st_size != MEM_ROM_BIOS_SIZE){
+		close(fd);
 		return -2;
 	}
+	data = vm_MapFile(fd, MEM_ROM_BIOS_SIZE);
+	close(fd);
+	if (!data)
+		return -1;
 
-	for (p = pVm->BIOS->data; bsize < fsize; *p = fgetc(bios), p++, bsize++);
-	fclose(bios);
+	if (pVm->bios_file)
+		munmap(pVm->bios_file, pVm->bios_file_size);
+	pVm->bios_file = data;
+	pVm->bios_file_size = MEM_ROM_BIOS_SIZE;
+	vm_SetPointers(pVm);
+	cpu_UpdatePageTable(pVm->cpu);
+	cpu_FlushBlocks(pVm->cpu);
 	return 0;
 }
 
-int8_t vm_Run(VM *pVm){
-	uint8_t exit = 0;
-	while (!exit){
-		cpu_Run(pVm->cpu);
-		vm_ReadKeys(pVm);
+int8_t vm_LoadRom(VM *pVm, const char *path){
+	Cpu *cpu = pVm->cpu;
+	struct stat st;
+	uint8_t *data, mbc;
+	uint32_t ram_size;
+	size_t size;
+	int fd;
 
-		// TODO: remove/define magic numbers
-		if(pVm->keys & 0x01)
-			exit = 1;
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -1;
+	if (fstat(fd, &st) != 0 || st.st_size < ROM_SIZE){
+		close(fd);
+		return -2;
+	}
+	data = vm_MapFile(fd, st.st_size);
+	close(fd);
+	if (!data)
+		return -1;
+
+	// Size declared by the header, the file has to hold all of it
+	size = data[ROM_HEADER_ROM_SIZE] <= ROM_SIZE_CODE_MAX ? (size_t)ROM_SIZE << data[ROM_HEADER_ROM_SIZE] : 0;
+	if (!size || size > (size_t)st.st_size){
+		munmap(data, st.st_size);
+		return -2;
+	}
+	if (mbc_Header(data, &mbc, &ram_size) != 0){
+		munmap(data, st.st_size);
+		return -3;
+	}
+	// Cartridge RAM of the previous cartridge is not carried over, nor written to its save file
+	if (cpu->sram && sram_Close(cpu->sram) != 0){
+		munmap(data, st.st_size);
+		return -4;
 	}
+
+	if (pVm->rom_file)
+		munmap(pVm->rom_file, pVm->rom_file_size);
+	pVm->rom_file = data;
+	pVm->rom_file_size = st.st_size;
+	mem_Setup(pVm->ROM, data, size, size / ROM_BANK_SIZE, ROM_BANK_SIZE);
+	memset(pVm->arena->ram, 0, ram_size);
+	mem_Setup(pVm->RAM, pVm->arena->ram, ram_size, ram_size / RAM_BANK_SIZE, RAM_BANK_SIZE);
+	// Snapshots track the RAM of the new cartridge, the memset bypassed the write path
+	if (cpu->snap)
+		snap_Invalidate(cpu->snap);
+	mem_CopyInfo(&cpu->map[MAP_ROM_BANK_0].mem, pVm->ROM);
+	mem_CopyInfo(&cpu->map[MAP_ROM_BANK_SWITCH].mem, pVm->ROM);
+	mem_CopyInfo(&cpu->map[MAP_RAM_BANK_SWITCH].mem, pVm->RAM);
+	mbc_Init(cpu, mbc);
+	cpu_UpdatePageTable(cpu);
+	cpu_FlushBlocks(cpu);
+	return 0;
+}
+
+int8_t vm_WriteLogo(VM *pVm){
+	static uint8_t logo[48] = { // Nintendo Logo
+		0xce, 0xed, 0x66, 0x66, 0xcc, 0x0d, 0x00, 0x0b,
+		0x03, 0x73, 0x00, 0x83, 0x00, 0x0c, 0x00, 0x0d,
+		0x00, 0x08, 0x11, 0x1f, 0x88, 0x89, 0x00, 0x0e,
+		0xdc, 0xcc, 0x6e, 0xe6, 0xdd, 0xdd, 0xd9, 0x99,
+		0xbb, 0xbb, 0x67, 0x63, 0x6e, 0x0e, 0xec, 0xcc,
+		0xdd, 0xdc, 0x99, 0x9f, 0xbb, 0xb9, 0x33, 0x3e
+	};
+	// Logo at $0104 in the cartridge header, a loaded cartridge has its own
+	if (pVm->rom_file || !mem_WriteMulti(pVm->ROM, 0x104, logo, sizeof(logo)))
+		return -1;
+	cpu_FlushBlocks(pVm->cpu);
 	return 0;
 }
 
-void vm_ReadKeys(VM *pVm){
-	pVm->keys = 0;
-	SDL_PollEvent(&pVm->ev);
-	switch(pVm->ev.type){
-		case SDLK_ESCAPE:
-		case SDL_QUIT:
-			pVm->keys |= 0x01;
-			break;
+int8_t vm_Run(VM *pVm, uint32_t frames){
+	uint32_t i;
+	for (i = 0; (!frames || i < frames) && !(pVm->keys & VM_KEY_EXIT); i++)
+		vm_RunFrame(pVm);
+	return 0;
+}
+
+void vm_RunFrame(VM *pVm){
+	// Frames are aligned on the clock, cycles run over by the last instruction are taken from this frame
+	cpu_RunCycles(pVm->cpu, LCD_FRAME_CYCLES - (pVm->cpu->clock_cycle % LCD_FRAME_CYCLES));
+}
+
+void vm_SetButtons(VM *pVm, uint8_t buttons){
+	joypad_Set(pVm->cpu, buttons);
+	return;
+}
+
+uint64_t vm_HashVideo(const VM *pVm){
+	const uint8_t *oam = pVm->cpu->map[MAP_OAM].mem.data;
+	uint64_t hash = 0xCBF29CE484222325ull; // FNV-1a
+	uint32_t i;
+
+	for (i = 0; i < MEM_VIDEO_RAM_SIZE; i++)
+		hash = (hash ^ pVm->VRAM->data[i]) * 0x100000001B3ull;
+	for (i = 0; i < MEM_SPRITE_ATTRI_SIZE; i++)
+		hash = (hash ^ oam[i]) * 0x100000001B3ull;
+	return hash;
+}
+
+int8_t vm_DumpRam(const VM *pVm, const char *path){
+	FILE *f = NULL;
+	uint32_t size;
+
+	f = fopen(path, "wb");
+	if (!f)
+		return -1;
+	size = fwrite(pVm->Internal_RAM->data, 1, MEM_RAM_INTERNAL_SIZE, f);
+	size += fwrite(pVm->RAM->data, 1, pVm->RAM->size, f);
+	fclose(f);
+	return size == MEM_RAM_INTERNAL_SIZE + pVm->RAM->size ? 0 : -2;
+}
+
+// Clear a pointer field of a saved arena image
+#define VM_STATE_CLEAR(image, offset, size) memset(&(image)[offset], 0, size)
+
+// Clear host pointers in a saved arena image, same state gives the same bytes
+static void vm_ClearPointers(uint8_t *pImage){
+	const size_t cpu = offsetof(VM_Arena, cpu);
+	uint8_t i;
+
+	VM_STATE_CLEAR(pImage, cpu + offsetof(Cpu, map), sizeof(void*));
+	VM_STATE_CLEAR(pImage, cpu + offsetof(Cpu, read_page), sizeof(void*) * MEM_PAGES * 2); // and write_page
+	VM_STATE_CLEAR(pImage, cpu + offsetof(Cpu, sfr), sizeof(void*));
+	VM_STATE_CLEAR(pImage, cpu + offsetof(Cpu, ie_reg), sizeof(void*));
+	VM_STATE_CLEAR(pImage, cpu + offsetof(Cpu, trace), offsetof(Cpu, serial_out) + sizeof(void*) - offsetof(Cpu, trace)); // host objects
+	for (i = 0; i < MEM_ADDRESS_SPACES; i++)
+		VM_STATE_CLEAR(pImage, offsetof(VM_Arena, map) + i * sizeof(MemoryMap) + offsetof(MemoryMap, mem.data), sizeof(void*));
+	VM_STATE_CLEAR(pImage, offsetof(VM_Arena, BIOS.data), sizeof(void*));
+	VM_STATE_CLEAR(pImage, offsetof(VM_Arena, ROM.data), sizeof(void*));
+	VM_STATE_CLEAR(pImage, offsetof(VM_Arena, VRAM.data), sizeof(void*));
+	VM_STATE_CLEAR(pImage, offsetof(VM_Arena, RAM.data), sizeof(void*));
+	VM_STATE_CLEAR(pImage, offsetof(VM_Arena, Internal_RAM.data), sizeof(void*));
+	return;
+}
+
+size_t vm_StateSize(const VM *pVm){
+	return sizeof(VM_State_Header) + VM_STATE_FIXED + pVm->RAM->size;
+}
+
+int8_t vm_SaveState(const VM *pVm, void *pBuffer, size_t size){
+	VM_State_Header *header = (VM_State_Header*)pBuffer;
+	uint8_t *image = (uint8_t*)pBuffer + sizeof(VM_State_Header);
+
+	if (size < vm_StateSize(pVm))
+		return -1;
+	header->magic = VM_STATE_MAGIC;
+	header->version = VM_STATE_VERSION;
+	header->header_size = sizeof(VM_State_Header);
+	header->arena_size = VM_STATE_FIXED;
+	header->ram_size = pVm->RAM->size;
+	memcpy(header->rom_check, &pVm->ROM->data[ROM_HEADER_CHECKSUM], sizeof(header->rom_check));
+	header->unused = 0;
+	memcpy(image, pVm->arena, VM_STATE_FIXED + pVm->RAM->size);
+	vm_ClearPointers(image);
+	return 0;
+}
+
+void vm_LoadCpu(VM *pVm, const uint8_t *pCpu){
+	Cpu *cpu = pVm->cpu;
+	Trace *trace = cpu->trace;
+	Block_Cache *blocks = cpu->blocks;
+	struct Jit *jit = cpu->jit;
+	struct Idle *idle = cpu->idle;
+	struct Prof *prof = cpu->prof;
+	struct CallProf *callprof = cpu->callprof;
+	struct Snap_Pool *snap = cpu->snap;
+	struct Sram *sram = cpu->sram;
+	struct Serial_Out *serial_out = cpu->serial_out;
+
+	memcpy(pVm->arena, pCpu, VM_STATE_CPU);
+	vm_SetPointers(pVm);
+	cpu->trace = trace;
+	cpu->blocks = blocks;
+	cpu->jit = jit;
+	cpu->idle = idle;
+	cpu->prof = prof;
+	cpu->callprof = callprof;
+	cpu->snap = snap;
+	cpu->sram = sram;
+	cpu->serial_out = serial_out;
+
+	// RAM code changed, blocks decoded from ROM are still valid
+	if (cpu->blocks)
+		block_FlushRam(cpu->blocks);
+	cpu_UpdatePageTable(cpu);
+	// Profiler sampling follows the loading VM
+	if (cpu->callprof)
+		callprof_Start(cpu, cpu->callprof);
+	else
+		sched_Remove(&cpu->sched, SCHED_EVENT_PROFILE);
+	return;
+}
+
+int8_t vm_LoadState(VM *pVm, const void *pBuffer, size_t size){
+	const VM_State_Header *header = (const VM_State_Header*)pBuffer;
+	const uint8_t *image = (const uint8_t*)pBuffer + sizeof(VM_State_Header);
+
+	if (size < sizeof(VM_State_Header))
+		return -1;
+	if (header->magic != VM_STATE_MAGIC || header->version != VM_STATE_VERSION
+		|| header->header_size != sizeof(VM_State_Header) || header->arena_size != VM_STATE_FIXED)
+		return -2;
+	if (memcmp(header->rom_check, &pVm->ROM->data[ROM_HEADER_CHECKSUM], sizeof(header->rom_check)) != 0
+		|| header->ram_size != pVm->RAM->size)
+		return -3; // saved with another cartridge
+	if (size < vm_StateSize(pVm))
+		return -1;
+
+	memcpy((uint8_t*)pVm->arena + VM_STATE_CPU, &image[VM_STATE_CPU], VM_STATE_FIXED - VM_STATE_CPU + header->ram_size);
+	if (pVm->cpu->snap)
+		snap_Invalidate(pVm->cpu->snap);
+	vm_LoadCpu(pVm, image);
+	return 0;
+}
+
+int8_t vm_SaveStateFile(const VM *pVm, const char *path){
+	size_t size = vm_StateSize(pVm);
+	uint8_t *buffer = NULL;
+	FILE *f = NULL;
+	int8_t ret = 0;
+
+	buffer = (uint8_t*)malloc(size);
+	if (!buffer)
+		return -1;
+	vm_SaveState(pVm, buffer, size);
+	f = fopen(path, "wb");
+	if (!f || fwrite(buffer, 1, size, f) != size)
+		ret = -2;
+	if (f && fclose(f) != 0)
+		ret = -2;
+	free(buffer);
+	return ret;
+}
+
+int8_t vm_LoadStateFile(VM *pVm, const char *path){
+	uint8_t *buffer = NULL;
+	FILE *f = NULL;
+	size_t size;
+	int8_t ret;
+
+	buffer = (uint8_t*)malloc(VM_STATE_MAX);
+	if (!buffer)
+		return -1;
+	f = fopen(path, "rb");
+	if (!f){
+		free(buffer);
+		return -2;
 	}
+	size = fread(buffer, 1, VM_STATE_MAX, f);
+	fclose(f);
+	ret = vm_LoadState(pVm, buffer, size);
+	free(buffer);
+	return ret;
 }
 
 void vm_Quit(VM *pVm){
-	mem_Free(pVm->BIOS);
-	mem_Free(pVm->ROM);
-	mem_Free(pVm->VRAM);
-	mem_Free(pVm->RAM);
-	mem_Free(pVm->Internal_RAM);
-	cpu_Free(pVm->cpu);
-
-	SDL_FreeSurface(pVm->ws);
-	SDL_DestroyWindow(pVm->w);
-	SDL_Quit();
+	// Save file written back while the arena exists, unmapped with it
+	if (pVm->cpu->sram)
+		sram_Free(pVm->cpu->sram);
+	// Detaching the pool maps the page table again, blocks still attached
+	if (pVm->cpu->snap)
+		snap_Free(pVm->cpu->snap);
+	if (pVm->cpu->blocks)
+		block_Free(pVm->cpu->blocks);
+	if (pVm->cpu->idle)
+		idle_Free(pVm->cpu->idle);
+	if (pVm->cpu->prof){
+		prof_Report(pVm->cpu->prof);
+		prof_Free(pVm->cpu->prof);
+	}
+	if (pVm->cpu->callprof){
+		callprof_Report(pVm->cpu->callprof);
+		callprof_Free(pVm->cpu->callprof);
+	}
+	if (pVm->cpu->serial_out)
+		serial_OutFree(pVm->cpu->serial_out);
+	vm_FreeArena(pVm);
+	vm_UnmapFiles(pVm);
+	free(pVm);
 }
@@ -3,7 +3,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
-#include <SDL2/SDL.h>
+#include <stddef.h>
 #include "debug.h"
 #include "rom.h"
 #include "ram.h"
@@ -11,13 +11,99 @@
 #include "memory_map.h"
 #include "lcd.h"
 #include "cpu.h"
+#include "idle.h"
+#include "prof.h"
+#include "callprof.h"
+#include "joypad.h"
+#include "serial.h"
+
+/*
+
+	Virtual machine
+
+	Emulation core only, no window or input library: front ends (main.c
+	with frontend.c for SDL, headless.c) run frames and set keys.
+
+	Guest memory, the Cpu and the memory descriptors live in one arena at
+	fixed offsets (VM_Arena), a single page aligned mapping per VM.
+	The arena can be backed by huge pages, hot path accesses then go
+	through one TLB entry.
+
+	The machine state is the arena up to the cartridge ROM: Cpu registers,
+	interrupt, timer and scheduler state, memory bank registers, then
+	RAM, VRAM, IO ports and HRAM, then the cartridge RAM. A save state is
+	a copy of it up to the RAM size of the loaded cartridge, 32KB for a
+	cartridge without RAM and 160KB at most (vm_StateSize), pointers
+	are derived again from the arena layout when it is loaded and host
+	objects attached to the Cpu (block cache, jit, profilers, trace) stay
+	those of the VM loading it. ROM and BIOS are not part of it, the
+	cartridge checksums are checked instead. States are only portable
+	between builds with the same VM_Arena layout.
+
+	Cartridge and bios files are mapped read only and the ROM maps point
+	into the mapping: loading does not depend on the ROM size and every
+	VM running the same cartridge shares its pages.
+
+*/
+
+// Keys set by the front end
+#define VM_KEY_EXIT (0x01)
+#define VM_KEY_REWIND (0x02) // held to step back through the rewind buffer
+
+// vm_Init flags
+#define VM_INIT_HUGE_PAGES (0x01) // back the arena with huge pages when the host has them
+
+#define VM_ARENA_ALIGN (4096)
+#define VM_HUGE_PAGE_SIZE (0x200000)
+
+// Guest memory and Cpu state of a VM
+typedef struct{
+	// Machine state, saved by vm_SaveState
+	// Cpu state, on its own cache lines
+	Cpu cpu __attribute__((aligned(64)));
+	MemoryMap map[MEM_ADDRESS_SPACES];
+	Memory BIOS;
+	Memory ROM;
+	Memory VRAM;
+	Memory RAM;
+	Memory Internal_RAM;
+	// Guest RAM, page aligned, most accessed first, only the RAM->size bytes of the cartridge are saved
+	uint8_t internal_ram[MEM_RAM_INTERNAL_SIZE_TOTAL] __attribute__((aligned(VM_ARENA_ALIGN)));
+	uint8_t vram[MEM_VIDEO_RAM_SIZE];
+	uint8_t ram[RAM_SIZE_MAX];
+
+	// ROM and bios images when no file is mapped (vm_WriteLogo), not saved
+	uint8_t rom[ROM_SIZE] __attribute__((aligned(VM_ARENA_ALIGN)));
+	uint8_t bios[MEM_ROM_BIOS_SIZE];
+}VM_Arena;
+
+#define VM_STATE_MAGIC (0x54534744) // "DGST"
+#define VM_STATE_VERSION (2)
+#define VM_STATE_CPU (offsetof(VM_Arena, internal_ram)) // Cpu and memory descriptors at the start of the state
+#define VM_STATE_FIXED (offsetof(VM_Arena, ram)) // arena bytes saved whatever the cartridge, its RAM follows
+#define VM_STATE_MAX (sizeof(VM_State_Header) + VM_STATE_FIXED + RAM_SIZE_MAX) // state of the largest cartridge RAM
+
+// Save state header, followed by VM_STATE_FIXED + ram_size bytes of arena
+typedef struct{
+	uint32_t magic; // VM_STATE_MAGIC
+	uint16_t version; // VM_STATE_VERSION
+	uint16_t header_size;
+	uint32_t arena_size; // VM_STATE_FIXED of the build that saved it
+	uint32_t ram_size; // cartridge RAM bytes saved
+	uint8_t rom_check[3]; // cartridge header and global checksums, $014D - $014F
+	uint8_t unused;
+}VM_State_Header;
 
 // Virtual Machine structure
 typedef struct{
-	SDL_Window *w;
-	SDL_Surface *ws;
-	SDL_Event ev;
-	uint32_t keys;
+	uint32_t keys; // VM_KEY_* set by the front end
+	VM_Arena *arena;
+	size_t arena_size; // bytes mapped
+	uint8_t arena_huge; // arena mapped with huge pages
+	uint8_t *rom_file; // cartridge file mapping, NULL uses the arena ROM
+	size_t rom_file_size;
+	uint8_t *bios_file; // bios file mapping, NULL uses the arena bios
+	size_t bios_file_size;
 	Memory *BIOS;
 	Memory *ROM;
 	Memory *VRAM;
@@ -26,15 +112,38 @@ typedef struct{
 	Cpu *cpu;
 }VM;
 
-// Initialize and return a VM structure
-VM* vm_Init(void);
-// Load bios to VM
-int8_t vm_LoadBios(VM *pVm, char *path);
-// Run VM
-int8_t vm_Run(VM *pVm);
-// Read keys
-void vm_ReadKeys(VM *pVm);
-// Quit vm
+// Initialize and return a VM structure, flags VM_INIT_*
+VM* vm_Init(uint8_t flags);
+// Map a bios file, returns 0 on success
+int8_t vm_LoadBios(VM *pVm, const char *path);
+// Map a cartridge file, ROM and RAM sizes and mapper from its header, returns 0 on success, -3 for an unsupported mapper,
+// -4 if the save file of the previous cartridge could not be detached (it stays attached, the VM is unchanged)
+int8_t vm_LoadRom(VM *pVm, const char *path);
+// Write the Nintendo logo to the arena ROM for the bios to check, without a cartridge, returns 0 on success
+int8_t vm_WriteLogo(VM *pVm);
+// Run frames, 0 runs until the front end sets VM_KEY_EXIT
+int8_t vm_Run(VM *pVm, uint32_t frames);
+// Run one frame worth of clock cycles
+void vm_RunFrame(VM *pVm);
+// Set pressed joypad buttons (JOYPAD_* mask)
+void vm_SetButtons(VM *pVm, uint8_t buttons);
+// Hash of VRAM and OAM, stands for the frame drawn from them
+uint64_t vm_HashVideo(const VM *pVm);
+// Write work RAM then cartridge RAM to a file, returns 0 on success
+int8_t vm_DumpRam(const VM *pVm, const char *path);
+// Returns the size of a save state of the loaded cartridge, VM_STATE_MAX at most
+size_t vm_StateSize(const VM *pVm);
+// Save machine state to buffer of size bytes (vm_StateSize at least), returns 0 on success
+int8_t vm_SaveState(const VM *pVm, void *pBuffer, size_t size);
+// Load machine state saved by vm_SaveState, returns 0 on success, the VM is unchanged on failure
+int8_t vm_LoadState(VM *pVm, const void *pBuffer, size_t size);
+// Load the state before the guest RAM (VM_STATE_CPU bytes of a saved arena), guest RAM already in place
+void vm_LoadCpu(VM *pVm, const uint8_t *pCpu);
+// Save machine state to a file, returns 0 on success
+int8_t vm_SaveStateFile(const VM *pVm, const char *path);
+// Load machine state from a file, returns 0 on success
+int8_t vm_LoadStateFile(VM *pVm, const char *path);
+// Quit vm and free it, writes the opcode and call stack profiles when attached
 void vm_Quit(VM *pVm);
 
 #endif